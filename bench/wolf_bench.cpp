@@ -0,0 +1,328 @@
+// wolf_bench: micro and end-to-end benchmarks of the library.
+//
+//   wolf_bench [--filter SUBSTR] [--min-time MS] [--json FILE]
+//              [--compare BASELINE.json] [--threshold FRACTION]
+//
+// --json writes the results; --compare reads a file written by --json and exits
+// with status 1 if any benchmark got slower than the baseline by more than
+// --threshold (default 0.10, i.e. 10%).
+#include <wolf.h>
+#include <math/simd/simd.h>
+#include <model/Loss.h>
+#include <runtime/ThreadPool.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <print>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace wolf;
+
+namespace {
+    struct Result {
+        std::string name;
+        double ns = 0.0;      // Median time per iteration
+        double gflops = 0.0;  // 0 when the benchmark does no arithmetic worth counting
+        double gbps = 0.0;    // Minimum bytes the iteration must touch / time
+        double per_sec = 0.0; // Iterations per second
+    };
+
+    struct Options {
+        std::string filter;
+        double min_time_ms = 200.0;
+        std::string json;
+        std::string compare;
+        double threshold = 0.10;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    class Runner {
+    public:
+        explicit Runner(const Options& opt) : opt(opt) {}
+
+        // Times body until min_time has passed; flops and bytes are per iteration.
+        void run(const std::string& name, double flops, double bytes, const std::function<void()>& body) {
+            if (!opt.filter.empty() && name.find(opt.filter) == std::string::npos) {
+                return;
+            }
+            body(); // Warm up: first-touch allocations, packing buffers, caches
+
+            // Iterations per sample so one sample lasts about 1 ms
+            size_t reps = 1;
+            for (;;) {
+                const auto t0 = Clock::now();
+                for (size_t i = 0; i < reps; ++i) {
+                    body();
+                }
+                if (Clock::now() - t0 >= std::chrono::milliseconds(1) || reps >= (size_t{1} << 20)) {
+                    break;
+                }
+                reps *= 2;
+            }
+            std::vector<double> samples;
+            const auto start = Clock::now();
+            while (samples.size() < 5 || std::chrono::duration<double, std::milli>(Clock::now() - start).count() < opt.min_time_ms) {
+                const auto t0 = Clock::now();
+                for (size_t i = 0; i < reps; ++i) {
+                    body();
+                }
+                samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / static_cast<double>(reps));
+            }
+            std::ranges::nth_element(samples, samples.begin() + samples.size() / 2);
+            Result r;
+            r.name = name;
+            r.ns = samples[samples.size() / 2];
+            r.gflops = flops / r.ns;
+            r.gbps = bytes / r.ns;
+            r.per_sec = 1e9 / r.ns;
+            std::println("{:<44} {:>12.1f} ns {:>9.2f} GFLOP/s {:>9.2f} GB/s {:>12.1f} /s",
+                         r.name, r.ns, r.gflops, r.gbps, r.per_sec);
+            results.push_back(std::move(r));
+        }
+
+        const std::vector<Result>& all() const { return results; }
+
+    private:
+        const Options& opt;
+        std::vector<Result> results;
+    };
+
+    std::vector<float> random_floats(size_t n, std::mt19937& gen) {
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::vector<float> v(n);
+        std::ranges::generate(v, [&] { return dist(gen); });
+        return v;
+    }
+
+    // One-hot targets of rows x classes
+    std::vector<float> random_targets(size_t rows, size_t classes, std::mt19937& gen) {
+        std::vector<float> t(rows * classes, 0.0f);
+        for (size_t r = 0; r < rows; ++r) {
+            t[r * classes + gen() % classes] = 1.0f;
+        }
+        return t;
+    }
+
+    void bench_linear(Runner& run, std::mt19937& gen) {
+        const size_t batches[] = {1, 32, 256};
+        const std::pair<size_t, size_t> shapes[] = {{128, 128}, {784, 128}, {1024, 1024}, {4096, 1024}};
+        for (auto [in, out] : shapes) {
+            for (size_t b : batches) {
+                LinearLayer layer(in, out);
+                std::vector<float> x = random_floats(b * in, gen);
+                std::vector<float> y(b * out);
+                std::vector<float> g = random_floats(b * out, gen);
+                std::vector<float> gx(b * in);
+                const TensorView xv{x.data(), b, in};
+                const TensorView yv{y.data(), b, out};
+                const TensorView gv{g.data(), b, out};
+                const TensorView gxv{gx.data(), b, in};
+                const auto shape = std::format("b{}_i{}_o{}", b, in, out);
+                const double mac = static_cast<double>(b * in * out);
+                const double w_bytes = 4.0 * static_cast<double>(in * out);
+                const double act_bytes = 4.0 * static_cast<double>(b * (in + out));
+
+                run.run("linear_forward/" + shape, 2.0 * mac, w_bytes + act_bytes,
+                        [&] { layer.forward_into(xv, yv); });
+                layer.forward_into(xv, yv);
+                // dW += g^T x reads and writes dW; grad_in = g W reads W
+                run.run("linear_backward/" + shape, 4.0 * mac, 3.0 * w_bytes + act_bytes + 4.0 * static_cast<double>(b * in),
+                        [&] { layer.backward_into(gv, gxv); });
+            }
+        }
+    }
+
+    void bench_optimizers(Runner& run) {
+        const double n = 1024.0 * 1024.0 + 1024.0;
+        // flops and bytes per parameter: each arena region the update reads and writes back
+        const std::tuple<OptimVariant, const char*, double, double> optimizers[] = {
+            {SGD{1e-6f}, "SGD", 2.0, 16.0},
+            {Momentum{1e-6f, 0.9f}, "Momentum", 4.0, 24.0},
+            {RMSProp{1e-6f, 0.99f}, "RMSProp", 7.0, 24.0},
+            {Adam{1e-6f}, "Adam", 12.0, 32.0},
+        };
+        for (const auto& [cfg, name, flops, bytes] : optimizers) {
+            Sequential model(Linear(1024, 1024));
+            model.set_optimizer(cfg);
+            run.run(std::format("step/{}/1M", name), flops * n, bytes * n, [&] { model.step(); });
+        }
+    }
+
+    void bench_losses(Runner& run, std::mt19937& gen) {
+        const size_t rows = 256;
+        const size_t cols = 1000;
+        std::vector<float> a = random_floats(rows * cols, gen);
+        std::vector<float> t = random_targets(rows, cols, gen);
+        const TensorView av{a.data(), rows, cols};
+        const TensorView tv{t.data(), rows, cols};
+        const std::pair<LossType, const char*> losses[] = {
+            {LossType::MSE, "MSE"}, {LossType::CrossEntropy, "CrossEntropy"}, {LossType::BCEWithLogits, "BCEWithLogits"},
+        };
+        for (auto [type, name] : losses) {
+            Sequential model;
+            model.set_loss(type);
+            const double n = static_cast<double>(rows * cols);
+            run.run(std::format("compute_grad_loss/{}/{}x{}", name, rows, cols), 0.0, 12.0 * n,
+                    [&] { model.compute_grad_loss(av, tv); });
+        }
+    }
+
+    void bench_gather(Runner& run, std::mt19937& gen) {
+        const size_t n = 20000;
+        const size_t dim = 784;
+        const size_t batch = 256;
+        std::vector<float> x = random_floats(n * dim, gen);
+        BatchMaker batcher(n);
+        batcher.shuffle(gen);
+        size_t start = 0;
+        run.run(std::format("batch_gather/b{}_d{}", batch, dim), 0.0, 8.0 * static_cast<double>(batch * dim), [&] {
+            batcher.x_batch(x, dim, start, batch);
+            start = start + 2 * batch <= n ? start + batch : 0;
+        });
+    }
+
+    void bench_training(Runner& run, std::mt19937& gen) {
+        const size_t in = 784;
+        const size_t classes = 10;
+        const size_t batch = 64;
+        const size_t n = 64 * batch;
+        std::vector<float> x = random_floats(n * in, gen);
+        std::vector<float> t = random_targets(n, classes, gen);
+        Sequential model(Linear(in, 256), ReLU(), Linear(256, 128), ReLU(), Linear(128, classes));
+        model.set_optimizer(SGD{0.01f});
+        model.set_loss(LossType::CrossEntropy);
+        const double mac = static_cast<double>(batch * (in * 256 + 256 * 128 + 128 * classes));
+        size_t start = 0;
+        run.run(std::format("train_step/mlp784-256-128-10_b{}", batch), 6.0 * mac, 0.0, [&] {
+            model.train_step(TensorView{x.data() + start * in, batch, in},
+                             TensorView{t.data() + start * classes, batch, classes});
+            start = start + 2 * batch <= n ? start + batch : 0;
+        });
+    }
+
+    void write_json(const std::string& path, const std::vector<Result>& results) {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("wolf_bench: failed to open " + path);
+        }
+        // One result per line, which is what read_baseline relies on
+        out << "{\n";
+        out << "  \"isa\": \"" << simd::isa_name(simd::kernels().isa) << "\",\n";
+        out << "  \"threads\": " << runtime::num_threads() << ",\n";
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << std::format("    {{\"name\": \"{}\", \"ns\": {:.3f}, \"gflops\": {:.4f}, \"gbps\": {:.4f}, \"per_sec\": {:.3f}}}{}\n",
+                               r.name, r.ns, r.gflops, r.gbps, r.per_sec, i + 1 < results.size() ? "," : "");
+        }
+        out << "  ]\n}\n";
+        if (!out) {
+            throw std::runtime_error("wolf_bench: failed to write " + path);
+        }
+    }
+
+    // name -> ns of a file written by write_json
+    std::map<std::string, double> read_baseline(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("wolf_bench: failed to open " + path);
+        }
+        std::map<std::string, double> ns;
+        std::string line;
+        while (std::getline(in, line)) {
+            const size_t name = line.find("\"name\": \"");
+            const size_t time = line.find("\"ns\": ");
+            if (name == std::string::npos || time == std::string::npos) {
+                continue;
+            }
+            const size_t begin = name + 9;
+            const size_t end = line.find('"', begin);
+            ns[line.substr(begin, end - begin)] = std::strtod(line.c_str() + time + 6, nullptr);
+        }
+        return ns;
+    }
+
+    // Returns the number of regressions.
+    int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double threshold) {
+        int regressions = 0;
+        std::println("\n{:<44} {:>12} {:>12} {:>8}", "benchmark", "baseline ns", "now ns", "change");
+        for (const Result& r : results) {
+            const auto it = baseline.find(r.name);
+            if (it == baseline.end()) {
+                std::println("{:<44} {:>12} {:>12.1f} {:>8}", r.name, "-", r.ns, "new");
+                continue;
+            }
+            const double change = r.ns / it->second - 1.0;
+            const bool slower = change > threshold;
+            regressions += slower;
+            std::println("{:<44} {:>12.1f} {:>12.1f} {:>+7.1f}%{}", r.name, it->second, r.ns, 100.0 * change,
+                         slower ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+
+    Options parse_args(int argc, char** argv) {
+        Options opt;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("wolf_bench: " + arg + " needs a value");
+                }
+                return argv[++i];
+            };
+            if (arg == "--filter") {
+                opt.filter = value();
+            } else if (arg == "--min-time") {
+                opt.min_time_ms = std::stod(value());
+            } else if (arg == "--json") {
+                opt.json = value();
+            } else if (arg == "--compare") {
+                opt.compare = value();
+            } else if (arg == "--threshold") {
+                opt.threshold = std::stod(value());
+            } else {
+                throw std::runtime_error("wolf_bench: unknown argument " + arg);
+            }
+        }
+        return opt;
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options opt = parse_args(argc, argv);
+        std::println("wolf_bench: {} threads, {} kernels", runtime::num_threads(), simd::isa_name(simd::kernels().isa));
+
+        std::mt19937 gen(42);
+        Runner run(opt);
+        bench_linear(run, gen);
+        bench_optimizers(run);
+        bench_losses(run, gen);
+        bench_gather(run, gen);
+        bench_training(run, gen);
+
+        if (!opt.json.empty()) {
+            write_json(opt.json, run.all());
+        }
+        if (!opt.compare.empty()) {
+            const int regressions = compare(run.all(), read_baseline(opt.compare), opt.threshold);
+            if (regressions > 0) {
+                std::println("{} benchmark(s) slower than the baseline by more than {:.0f}%", regressions, 100.0 * opt.threshold);
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::println(stderr, "{}", e.what());
+        return 2;
+    }
+    return 0;
+}
@@ -1,6 +1,4 @@
 #include <wolf.h>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <random>
@@ -15,56 +13,6 @@ using namespace wolf;
 const int num_pixels = 784;
 const int num_classes = 10;
 
-std::size_t load_mnist_csv(
-    const std::string& path,
-    std::vector<float>& x_data,   // will contain N * 784 floats
-    std::vector<float>& t_data   // will contain N labels as floats
-) {
-    std::ifstream in(path);
-    if (!in) {
-        throw std::runtime_error("Failed to open " + path);
-    }
-    std::string line;
-
-    // Skip header
-    if (!std::getline(in, line)) {
-        throw std::runtime_error("Empty MNIST file");
-    }
-
-
-    std::size_t num_samples = 0;
-
-    while (std::getline(in, line)) {
-        if (line.empty()) continue;
-
-        std::stringstream ss(line);
-        std::string field;
-        if (!std::getline(ss, field, ',')) {
-            continue;
-        }
-
-        int label = std::stoi(field);
-        for (int i = 0; i < num_classes; i++) {
-            t_data.push_back(i == label ? 1 : 0);
-        }
-
-        for (int i = 0; i < num_pixels; ++i) {
-            if (!std::getline(ss, field, ',')) {
-                throw std::runtime_error(
-                    "Malformed MNIST row (not enough pixels) in " + path
-                );
-            }
-            int pix = std::stoi(field);
-            float norm_pix = static_cast<float>(pix) / 255.0f; // [0, 1]
-            x_data.push_back(norm_pix);
-        }
-
-        ++num_samples;
-    }
-
-    return num_samples;
-}
-
 int main(int argc, char** argv) {
     // retrieves dataset from <build>/examples/data/mnist_test.csv
     // dataset from https://www.kaggle.com/datasets/oddrationale/mnist-in-csv
@@ -79,12 +27,16 @@ int main(int argc, char** argv) {
     std::println("Loading MNIST train from: {}", train_path.string());
     std::println("Loading MNIST test  from: {}", test_path.string());
 
-    std::vector<float> x_data;
-    std::vector<float> t_data;
-    std::vector<float> x_test_data;
-    std::vector<float> t_test_data;
-    size_t n_train_samples = load_mnist_csv(train_path.string(), x_data, t_data);
-    size_t n_test_samples = load_mnist_csv(test_path.string(), x_test_data, t_test_data);
+    // Label first, then 784 pixels scaled to [0, 1]. Parsed once, then read from the binary cache.
+    CsvOptions csv{.label_column = 0, .num_classes = num_classes, .feature_scale = 1.0f / 255.0f};
+    Dataset train = load_csv_cached(train_path.string(), (data_dir / "mnist_train.bin").string(), csv);
+    Dataset test = load_csv_cached(test_path.string(), (data_dir / "mnist_test.bin").string(), csv);
+    std::span<float> x_data = train.inputs();
+    std::span<float> t_data = train.targets();
+    std::span<float> x_test_data = test.inputs();
+    std::span<float> t_test_data = test.targets();
+    size_t n_train_samples = train.rows;
+    size_t n_test_samples = test.rows;
 
 
     std::println("Loaded {} train samples, {} test samples",
@@ -102,9 +54,11 @@ int main(int argc, char** argv) {
     OptimVariant cfg = SGD{lr};
     model.set_optimizer(cfg);
     model.set_loss(LossType::CrossEntropy);
+    model.init(batch_size, num_pixels); // Preallocate activations and gradients
 
     std::mt19937 gen(std::random_device{}());
     BatchMaker batcher(n_train_samples);
+    batcher.enable_prefetch(x_data, num_pixels, t_data, num_classes, batch_size); // Gathers ahead on a background thread
     // Training
 
     for (size_t epoch = 0; epoch < epochs; ++epoch) {
@@ -116,14 +70,11 @@ int main(int argc, char** argv) {
             TensorView x_batch = batcher.x_batch(x_data, num_pixels, s, current_bs);
             TensorView t_batch = batcher.t_batch(t_data, num_classes, s, current_bs);
             TensorView logits = model.pred(x_batch);
-            model.compute_grad_loss(logits, t_batch);
+            epoch_loss += model.compute_loss_and_grad(logits, t_batch);
             model.backward();
             model.step(current_bs);
 
             // End of core training loop
-
-            float loss = cross_entropy_loss(logits, t_batch);
-            epoch_loss += loss;
         }
 
         float avg_loss = epoch_loss / static_cast<float>(n_train_samples);
@@ -132,6 +83,7 @@ int main(int argc, char** argv) {
     }
 
     // Evaluation on test set
+    auto no_grad = model.inference_mode(); // Layers keep nothing for backward
     int correct = 0;
     for (size_t j = 0; j < n_test_samples; j++) {
         TensorView x_batch = make_batch_view(x_test_data, num_pixels, j, 1);
@@ -0,0 +1,66 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace wolf {
+
+constexpr std::size_t tensor_alignment = 64; // One cache line, one AVX-512 register
+
+// Rounds a float count up so whatever follows starts on a tensor_alignment boundary.
+constexpr std::size_t align_floats(std::size_t n) {
+    constexpr std::size_t step = tensor_alignment / sizeof(float);
+    return (n + step - 1) / step * step;
+}
+
+// Row length for a [rows x cols] matrix that keeps every row tensor_alignment aligned and
+// avoids power-of-two strides: rows 4 KiB apart map to the same cache sets, so walking
+// down a column of such a matrix evicts itself (4K aliasing).
+constexpr std::size_t padded_ld(std::size_t cols) {
+    constexpr std::size_t step = tensor_alignment / sizeof(float);
+    const std::size_t ld = align_floats(cols);
+    return ld * sizeof(float) % 4096 == 0 ? ld + step : ld;
+}
+
+// std::allocator with tensor_alignment for vectors of floats (Tensor's storage).
+template <class T>
+struct AlignedAllocator {
+    using value_type = T;
+    AlignedAllocator() = default;
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new[](n * sizeof(T), std::align_val_t{tensor_alignment}));
+    }
+    void deallocate(T* p, std::size_t) { ::operator delete[](p, std::align_val_t{tensor_alignment}); }
+    template <class U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+};
+using AlignedVector = std::vector<float, AlignedAllocator<float>>;
+
+// Zero-initialised, tensor_alignment aligned float storage.
+class AlignedBuffer {
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(std::size_t n) : ptr(allocate(n)), n(n) {
+        std::fill_n(ptr.get(), n, 0.0f);
+    }
+    float* data() { return ptr.get(); }
+    const float* data() const { return ptr.get(); }
+    std::size_t size() const { return n; }
+
+private:
+    struct Free {
+        void operator()(float* p) const { ::operator delete[](p, std::align_val_t{tensor_alignment}); }
+    };
+    static float* allocate(std::size_t n) {
+        return static_cast<float*>(::operator new[](std::max<std::size_t>(n, 1) * sizeof(float),
+                                                    std::align_val_t{tensor_alignment}));
+    }
+    std::unique_ptr<float[], Free> ptr;
+    std::size_t n = 0;
+};
+
+}
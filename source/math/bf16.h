@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace wolf {
+
+// bfloat16: the upper 16 bits of an IEEE float. Same range as float, 8 bits of mantissa.
+struct bf16 {
+    uint16_t bits;
+};
+
+inline float to_float(bf16 h) {
+    const uint32_t u = static_cast<uint32_t>(h.bits) << 16;
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Round to nearest even; NaNs stay (quiet) NaNs.
+inline bf16 to_bf16(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7fffffffu) > 0x7f800000u) {
+        return bf16{static_cast<uint16_t>((u >> 16) | 0x40u)};
+    }
+    u += 0x7fffu + ((u >> 16) & 1u);
+    return bf16{static_cast<uint16_t>(u >> 16)};
+}
+
+}
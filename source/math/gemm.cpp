@@ -0,0 +1,202 @@
+#include <math/gemm.h>
+#include <math/simd/simd.h>
+#include <runtime/ThreadPool.h>
+#include <algorithm>
+#include <vector>
+
+namespace wolf {
+    namespace {
+        // Cache blocks. The register tile (MR x NR) comes from the ISA's micro-kernel;
+        // MC and NC are multiples of every MR and NR in use.
+        // B sliver  (KC x NR) stays in L1, A block (MC x KC) in L2, B panel (KC x NC) in L3.
+        constexpr std::size_t MC = 72;
+        constexpr std::size_t KC = 256;
+        constexpr std::size_t NC = 2048;
+
+        // Below this many multiply-adds the fork/join costs more than it saves.
+        constexpr std::size_t parallel_threshold = 1 << 15;
+
+        inline float load(float x) { return x; }
+        inline float load(bf16 x) { return to_float(x); }
+
+        // Element (i, k) of op(A) and element (k, j) of op(B), widened to float.
+        template <class T>
+        inline float at(const T* X, std::size_t ld, Trans t, std::size_t r, std::size_t c) {
+            return load(t == Trans::No ? X[r * ld + c] : X[c * ld + r]);
+        }
+
+        // Pack an mc x kc block of op(A) into MR-row slivers laid out k-major.
+        // Rows past mc are zero padded so the micro-kernel never branches.
+        void pack_A(Trans ta, std::size_t MR, std::size_t mc, std::size_t kc, const float* A, std::size_t lda, float* Ap) {
+            for (std::size_t i0 = 0; i0 < mc; i0 += MR) {
+                const std::size_t mr = std::min(MR, mc - i0);
+                for (std::size_t k = 0; k < kc; ++k) {
+                    for (std::size_t i = 0; i < mr; ++i) {
+                        Ap[k * MR + i] = at(A, lda, ta, i0 + i, k);
+                    }
+                    for (std::size_t i = mr; i < MR; ++i) {
+                        Ap[k * MR + i] = 0.0f;
+                    }
+                }
+                Ap += kc * MR;
+            }
+        }
+
+        // Pack a kc x nc panel of op(B) into NR-column slivers (always fp32).
+        template <class TB>
+        void pack_B(Trans tb, std::size_t NR, std::size_t nc, std::size_t kc, const TB* B, std::size_t ldb, float* Bp) {
+            for (std::size_t j0 = 0; j0 < nc; j0 += NR) {
+                const std::size_t nr = std::min(NR, nc - j0);
+                for (std::size_t k = 0; k < kc; ++k) {
+                    for (std::size_t j = 0; j < nr; ++j) {
+                        Bp[k * NR + j] = at(B, ldb, tb, k, j0 + j);
+                    }
+                    for (std::size_t j = nr; j < NR; ++j) {
+                        Bp[k * NR + j] = 0.0f;
+                    }
+                }
+                Bp += kc * NR;
+            }
+        }
+
+        // Offset of the sub-matrix of op(X) starting at (r, c).
+        template <class T>
+        inline const T* offset(const T* X, std::size_t ld, Trans t, std::size_t r, std::size_t c) {
+            return t == Trans::No ? X + r * ld + c : X + c * ld + r;
+        }
+
+        void apply_epilogue(const GemmEpilogue& ep, float* C, std::size_t ldc,
+                            std::size_t m0, std::size_t n0, std::size_t mr, std::size_t nr) {
+            if (ep.bias != nullptr) {
+                for (std::size_t i = 0; i < mr; ++i) {
+                    float* c = C + i * ldc;
+                    for (std::size_t j = 0; j < nr; ++j) {
+                        c[j] += ep.bias[n0 + j];
+                    }
+                }
+            }
+            if (ep.act == Activation::ReLU) {
+                for (std::size_t i = 0; i < mr; ++i) {
+                    float* c = C + i * ldc;
+                    for (std::size_t j = 0; j < nr; ++j) {
+                        c[j] = c[j] > 0.0f ? c[j] : 0.0f;
+                    }
+                    if (ep.mask != nullptr) {
+                        uint8_t* m = ep.mask + (m0 + i) * ep.ldm + n0;
+                        for (std::size_t j = 0; j < nr; ++j) {
+                            m[j] = c[j] > 0.0f;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Single-threaded Goto/BLIS loop nest over one rectangular piece of C.
+        template <class TB>
+        void gemm_block(const simd::GemmMicroKernel& uk,
+                        Trans ta, Trans tb, std::size_t M, std::size_t N, std::size_t K,
+                        const float* A, std::size_t lda,
+                        const TB* B, std::size_t ldb,
+                        float beta, float* C, std::size_t ldc,
+                        std::size_t m_offset, std::size_t n_offset, const GemmEpilogue& ep) {
+            // Grown on first use, reused by every later call on this thread.
+            thread_local std::vector<float> Ap;
+            thread_local std::vector<float> Bp;
+            const std::size_t MR = uk.mr;
+            const std::size_t NR = uk.nr;
+            const std::size_t kc_max = std::min(KC, K);
+            Ap.resize(std::max(Ap.size(), (MC + MR) * kc_max));
+            Bp.resize(std::max(Bp.size(), (std::min(NC, N) + NR) * kc_max));
+
+            for (std::size_t jc = 0; jc < N; jc += NC) {
+                const std::size_t nc = std::min(NC, N - jc);
+                for (std::size_t pc = 0; pc < K; pc += KC) {
+                    const std::size_t kc = std::min(KC, K - pc);
+                    const bool last_k = pc + kc == K;
+                    pack_B(tb, NR, nc, kc, offset(B, ldb, tb, pc, jc), ldb, Bp.data());
+
+                    for (std::size_t ic = 0; ic < M; ic += MC) {
+                        const std::size_t mc = std::min(MC, M - ic);
+                        pack_A(ta, MR, mc, kc, offset(A, lda, ta, ic, pc), lda, Ap.data());
+
+                        for (std::size_t jr = 0; jr < nc; jr += NR) {
+                            const std::size_t nr = std::min(NR, nc - jr);
+                            const float* b = Bp.data() + jr * kc;
+                            for (std::size_t ir = 0; ir < mc; ir += MR) {
+                                const std::size_t mr = std::min(MR, mc - ir);
+                                float* c = C + (ic + ir) * ldc + jc + jr;
+                                uk.run(kc, Ap.data() + ir * kc, b, c, ldc, mr, nr, pc == 0 ? beta : 1.0f);
+                                if (last_k) {
+                                    apply_epilogue(ep, c, ldc, m_offset + ic + ir, n_offset + jc + jr, mr, nr);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template <class TB>
+        void gemm_impl(Trans ta, Trans tb, std::size_t M, std::size_t N, std::size_t K,
+                       const float* A, std::size_t lda,
+                       const TB* B, std::size_t ldb,
+                       float beta, float* C, std::size_t ldc,
+                       const GemmEpilogue& ep) {
+            if (M == 0 || N == 0) {
+                return;
+            }
+            if (K == 0) {
+                for (std::size_t i = 0; i < M; ++i) {
+                    float* c = C + i * ldc;
+                    for (std::size_t j = 0; j < N; ++j) {
+                        c[j] = beta == 0.0f ? 0.0f : beta * c[j];
+                    }
+                    apply_epilogue(ep, c, ldc, i, 0, 1, N);
+                }
+                return;
+            }
+            // Split C into a tm x tn grid of independent pieces, one per thread.
+            // Columns first: every piece then shares the A rows, which are small for typical batches.
+            const std::size_t threads = M * N * K >= parallel_threshold ? runtime::num_threads() : 1;
+            const simd::GemmMicroKernel& uk = simd::kernels().gemm;
+            const std::size_t MR = uk.mr;
+            const std::size_t NR = uk.nr;
+            const std::size_t n_groups = (N + NR - 1) / NR;
+            const std::size_t m_groups = (M + MR - 1) / MR;
+            const std::size_t tn = std::min(threads, n_groups);
+            const std::size_t tm = std::min(std::max<std::size_t>(1, threads / tn), m_groups);
+            const std::size_t n_step = (n_groups + tn - 1) / tn * NR;
+            const std::size_t m_step = (m_groups + tm - 1) / tm * MR;
+
+            runtime::parallel_for(tm * tn, 1, [&](std::size_t t, std::size_t) {
+                const std::size_t m0 = (t / tn) * m_step;
+                const std::size_t n0 = (t % tn) * n_step;
+                if (m0 >= M || n0 >= N) {
+                    return;
+                }
+                const std::size_t m = std::min(m_step, M - m0);
+                const std::size_t n = std::min(n_step, N - n0);
+                gemm_block(uk, ta, tb, m, n, K,
+                           offset(A, lda, ta, m0, 0), lda,
+                           offset(B, ldb, tb, 0, n0), ldb,
+                           beta, C + m0 * ldc + n0, ldc, m0, n0, ep);
+            });
+        }
+    }
+
+    void gemm(Trans ta, Trans tb, std::size_t M, std::size_t N, std::size_t K,
+              const float* A, std::size_t lda,
+              const float* B, std::size_t ldb,
+              float beta, float* C, std::size_t ldc,
+              const GemmEpilogue& ep) {
+        gemm_impl(ta, tb, M, N, K, A, lda, B, ldb, beta, C, ldc, ep);
+    }
+
+    void gemm(Trans ta, Trans tb, std::size_t M, std::size_t N, std::size_t K,
+              const float* A, std::size_t lda,
+              const bf16* B, std::size_t ldb,
+              float beta, float* C, std::size_t ldc,
+              const GemmEpilogue& ep) {
+        gemm_impl(ta, tb, M, N, K, A, lda, B, ldb, beta, C, ldc, ep);
+    }
+}
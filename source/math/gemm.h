@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <math/bf16.h>
+#include <math/tensor.h>
+
+namespace wolf {
+
+enum class Activation : uint8_t {
+    None,
+    ReLU,
+};
+
+// Applied to each finished C tile while it is still in cache: bias, then activation.
+struct GemmEpilogue {
+    const float* bias = nullptr; // [N], added to every row of C
+    Activation act = Activation::None;
+    uint8_t* mask = nullptr;     // Optional [M x N] with row stride ldm: 1 where the activation passed its input
+    std::size_t ldm = 0;
+};
+
+enum class Trans : uint8_t {
+    No,  // operand used as stored
+    Yes, // operand used transposed
+};
+
+// Packed, cache-blocked SGEMM:
+// C[M x N] = op(A)[M x K] * op(B)[K x N] + beta * C (+ bias)
+// All matrices are row-major; lda, ldb, ldc are the stored row lengths.
+// beta = 0 overwrites C (its old contents are never read), beta = 1 accumulates.
+void gemm(Trans ta, Trans tb, std::size_t M, std::size_t N, std::size_t K,
+          const float* A, std::size_t lda,
+          const float* B, std::size_t ldb,
+          float beta, float* C, std::size_t ldc,
+          const GemmEpilogue& ep = {});
+
+// Mixed precision: B stored as bfloat16, widened while it is packed. Accumulation stays fp32.
+void gemm(Trans ta, Trans tb, std::size_t M, std::size_t N, std::size_t K,
+          const float* A, std::size_t lda,
+          const bf16* B, std::size_t ldb,
+          float beta, float* C, std::size_t ldc,
+          const GemmEpilogue& ep = {});
+
+// A view as a gemm operand: op(view) is op(stored) for a row-major view and the opposite
+// for a column-major one, which gemm reads as its transpose.
+struct GemmOperand {
+    Trans trans;
+    const float* data;
+    std::size_t ld;
+};
+inline GemmOperand gemm_operand(const TensorView& v, Trans t = Trans::No) {
+    if (v.row_major()) {
+        return {t, v.data, v.stride};
+    }
+    return {t == Trans::No ? Trans::Yes : Trans::No, v.data, v.col_stride};
+}
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <runtime/ThreadPool.h>
+
+namespace wolf {
+
+// Elements per task for streaming elementwise kernels (64 KiB of floats).
+constexpr std::size_t elementwise_grain = 1 << 14;
+
+// Splits [0, n) into chunks of `grain` elements and runs fn(begin, end) on each in parallel.
+// A single chunk runs inline without touching the thread pool.
+template <class F>
+inline void parallel_chunks(std::size_t n, std::size_t grain, F&& fn) {
+    runtime::parallel_for(n, grain, std::forward<F>(fn));
+}
+
+}
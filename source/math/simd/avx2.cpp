@@ -0,0 +1,92 @@
+// Compiled with -mavx2 -mfma; only reached after CPUID confirms support.
+#include <math/simd/kernels.h>
+#include <immintrin.h>
+
+namespace wolf::simd {
+namespace {
+
+struct Avx2 {
+    using reg = __m256;
+    using ireg = __m256i;
+    using mask = __m256;
+    static constexpr std::size_t width = 8;
+
+    static reg load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+    static reg set1(float v) { return _mm256_set1_ps(v); }
+    static reg zero() { return _mm256_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    static reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+    static reg fma(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+    static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+    static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+    static reg sqrt(reg a) { return _mm256_sqrt_ps(a); }
+    static reg abs(reg a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static mask gt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static mask lt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static reg select(mask m, reg a, reg b) { return _mm256_blendv_ps(b, a, m); }
+    static float hsum(reg v) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+    static float hmax(reg v) {
+        __m128 s = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_max_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+
+    static ireg cvt_f2i(reg v) { return _mm256_cvtps_epi32(v); }
+    static reg cvt_i2f(ireg v) { return _mm256_cvtepi32_ps(v); }
+    static ireg as_int(reg v) { return _mm256_castps_si256(v); }
+    static reg as_float(ireg v) { return _mm256_castsi256_ps(v); }
+    static ireg iset1(std::int32_t v) { return _mm256_set1_epi32(v); }
+    static ireg iadd(ireg a, ireg b) { return _mm256_add_epi32(a, b); }
+    static ireg isub(ireg a, ireg b) { return _mm256_sub_epi32(a, b); }
+    static ireg iand(ireg a, ireg b) { return _mm256_and_si256(a, b); }
+    static ireg ior(ireg a, ireg b) { return _mm256_or_si256(a, b); }
+    template <int S> static ireg slli(ireg v) { return _mm256_slli_epi32(v, S); }
+    template <int S> static ireg srli(ireg v) { return _mm256_srli_epi32(v, S); }
+    static mask unord(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_UNORD_Q); }
+
+    static ireg load_bf16(const std::uint16_t* p) {
+        return _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), 16);
+    }
+    static void store_bf16(std::uint16_t* p, ireg v) {
+        const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packed);
+    }
+
+    // maddubs multiplies unsigned by signed bytes: move a's sign onto b. With both in
+    // [-127, 127] the pairwise 16-bit sums stay below 2 * 127 * 127 and never saturate.
+    static constexpr std::size_t s8_width = 32;
+    static ireg izero() { return _mm256_setzero_si256(); }
+    static ireg dot_s8(ireg acc, const std::int8_t* a, const std::int8_t* b) {
+        const __m256i av = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        const __m256i bv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        const __m256i pairs = _mm256_maddubs_epi16(_mm256_sign_epi8(av, av), _mm256_sign_epi8(bv, av));
+        return _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, _mm256_set1_epi16(1)));
+    }
+    static std::int32_t ihsum(ireg v) {
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(s);
+    }
+    static std::size_t count_eq(const char* p, char c) {
+        const __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), _mm256_set1_epi8(c));
+        return std::popcount(static_cast<unsigned>(_mm256_movemask_epi8(eq)));
+    }
+};
+
+}
+
+    const Kernels& avx2_kernels() {
+        static const Kernels k = make_kernels<Avx2, 6, 16>(Isa::AVX2);
+        return k;
+    }
+}
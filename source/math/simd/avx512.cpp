@@ -0,0 +1,75 @@
+// Compiled with -mavx512f -mavx512bw -mavx512dq -mavx512vl; only reached after CPUID confirms support.
+#include <math/simd/kernels.h>
+#include <immintrin.h>
+
+namespace wolf::simd {
+namespace {
+
+struct Avx512 {
+    using reg = __m512;
+    using ireg = __m512i;
+    using mask = __mmask16;
+    static constexpr std::size_t width = 16;
+
+    static reg load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, reg v) { _mm512_storeu_ps(p, v); }
+    static reg set1(float v) { return _mm512_set1_ps(v); }
+    static reg zero() { return _mm512_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+    static reg div(reg a, reg b) { return _mm512_div_ps(a, b); }
+    static reg fma(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+    static reg max(reg a, reg b) { return _mm512_max_ps(a, b); }
+    static reg min(reg a, reg b) { return _mm512_min_ps(a, b); }
+    static reg sqrt(reg a) { return _mm512_sqrt_ps(a); }
+    static reg abs(reg a) { return _mm512_abs_ps(a); }
+    static mask gt(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static mask lt(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static reg select(mask m, reg a, reg b) { return _mm512_mask_blend_ps(m, b, a); }
+    static float hsum(reg v) { return _mm512_reduce_add_ps(v); }
+    static float hmax(reg v) { return _mm512_reduce_max_ps(v); }
+
+    static ireg cvt_f2i(reg v) { return _mm512_cvtps_epi32(v); }
+    static reg cvt_i2f(ireg v) { return _mm512_cvtepi32_ps(v); }
+    static ireg as_int(reg v) { return _mm512_castps_si512(v); }
+    static reg as_float(ireg v) { return _mm512_castsi512_ps(v); }
+    static ireg iset1(std::int32_t v) { return _mm512_set1_epi32(v); }
+    static ireg iadd(ireg a, ireg b) { return _mm512_add_epi32(a, b); }
+    static ireg isub(ireg a, ireg b) { return _mm512_sub_epi32(a, b); }
+    static ireg iand(ireg a, ireg b) { return _mm512_and_si512(a, b); }
+    static ireg ior(ireg a, ireg b) { return _mm512_or_si512(a, b); }
+    template <int S> static ireg slli(ireg v) { return _mm512_slli_epi32(v, S); }
+    template <int S> static ireg srli(ireg v) { return _mm512_srli_epi32(v, S); }
+    static mask unord(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q); }
+
+    static ireg load_bf16(const std::uint16_t* p) {
+        return _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))), 16);
+    }
+    static void store_bf16(std::uint16_t* p, ireg v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi32_epi16(v));
+    }
+
+    // As AVX2, without sign_epi8: negate b where a is negative. See avx512vnni.cpp for VNNI.
+    static constexpr std::size_t s8_width = 64;
+    static ireg izero() { return _mm512_setzero_si512(); }
+    static ireg dot_s8(ireg acc, const std::int8_t* a, const std::int8_t* b) {
+        const __m512i av = _mm512_loadu_si512(a);
+        const __m512i bv = _mm512_loadu_si512(b);
+        const __m512i b_signed = _mm512_mask_sub_epi8(bv, _mm512_movepi8_mask(av), _mm512_setzero_si512(), bv);
+        const __m512i pairs = _mm512_maddubs_epi16(_mm512_abs_epi8(av), b_signed);
+        return _mm512_add_epi32(acc, _mm512_madd_epi16(pairs, _mm512_set1_epi16(1)));
+    }
+    static std::int32_t ihsum(ireg v) { return _mm512_reduce_add_epi32(v); }
+    static std::size_t count_eq(const char* p, char c) {
+        return std::popcount(_mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p), _mm512_set1_epi8(c)));
+    }
+};
+
+}
+
+    const Kernels& avx512_kernels() {
+        static const Kernels k = make_kernels<Avx512, 6, 32>(Isa::AVX512);
+        return k;
+    }
+}
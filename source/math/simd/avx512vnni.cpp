@@ -0,0 +1,71 @@
+// Compiled with the AVX-512 flags plus -mavx512vnni; only reached after CPUID confirms support.
+// Everything but the int8 kernel is the plain AVX-512 table.
+#include <math/simd/simd.h>
+#include <immintrin.h>
+
+namespace wolf::simd {
+    const Kernels& avx512_kernels();
+
+namespace {
+
+// vpdpbusd: u8 x s8 products summed straight into 32 bits, no 16-bit intermediate.
+inline __m512i dot_step(__m512i acc, const std::int8_t* a, const std::int8_t* b) {
+    const __m512i av = _mm512_loadu_si512(a);
+    const __m512i bv = _mm512_loadu_si512(b);
+    const __m512i b_signed = _mm512_mask_sub_epi8(bv, _mm512_movepi8_mask(av), _mm512_setzero_si512(), bv);
+    return _mm512_dpbusd_epi32(acc, _mm512_abs_epi8(av), b_signed);
+}
+
+void dot_s8_vnni(const std::int8_t* a, const std::int8_t* B, std::size_t ldb, std::size_t n, std::size_t k, std::int32_t* out) {
+    constexpr std::size_t width = 64;
+    std::size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const std::int8_t* b0 = B + j * ldb;
+        const std::int8_t* b1 = b0 + ldb;
+        const std::int8_t* b2 = b1 + ldb;
+        const std::int8_t* b3 = b2 + ldb;
+        __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+        __m512i acc2 = _mm512_setzero_si512(), acc3 = _mm512_setzero_si512();
+        std::size_t i = 0;
+        for (; i + width <= k; i += width) {
+            acc0 = dot_step(acc0, a + i, b0 + i);
+            acc1 = dot_step(acc1, a + i, b1 + i);
+            acc2 = dot_step(acc2, a + i, b2 + i);
+            acc3 = dot_step(acc3, a + i, b3 + i);
+        }
+        std::int32_t s0 = _mm512_reduce_add_epi32(acc0), s1 = _mm512_reduce_add_epi32(acc1);
+        std::int32_t s2 = _mm512_reduce_add_epi32(acc2), s3 = _mm512_reduce_add_epi32(acc3);
+        for (; i < k; ++i) {
+            s0 += a[i] * b0[i];
+            s1 += a[i] * b1[i];
+            s2 += a[i] * b2[i];
+            s3 += a[i] * b3[i];
+        }
+        out[j] = s0; out[j + 1] = s1; out[j + 2] = s2; out[j + 3] = s3;
+    }
+    for (; j < n; ++j) {
+        const std::int8_t* b = B + j * ldb;
+        __m512i acc = _mm512_setzero_si512();
+        std::size_t i = 0;
+        for (; i + width <= k; i += width) {
+            acc = dot_step(acc, a + i, b + i);
+        }
+        std::int32_t s = _mm512_reduce_add_epi32(acc);
+        for (; i < k; ++i) {
+            s += a[i] * b[i];
+        }
+        out[j] = s;
+    }
+}
+
+}
+
+    const Kernels& avx512_vnni_kernels() {
+        static const Kernels k = [] {
+            Kernels t = avx512_kernels();
+            t.dot_s8 = &dot_s8_vnni;
+            return t;
+        }();
+        return k;
+    }
+}
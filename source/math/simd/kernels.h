@@ -0,0 +1,502 @@
+// Generic kernel bodies, instantiated once per instruction set.
+// Only the per-ISA translation units in this directory include this file. Everything is in an
+// anonymous namespace so code compiled with -mavx2 / -mavx512f never gets merged by the linker
+// into a function that baseline code calls.
+#pragma once
+#include <math/simd/simd.h>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace wolf::simd {
+namespace {
+
+// Every ISA provides the same set of static operations on its register type.
+// Scalar doubles as the tail handler for the vector ISAs.
+struct Scalar {
+    using reg = float;
+    using ireg = std::int32_t;
+    using mask = bool;
+    static constexpr std::size_t width = 1;
+
+    static reg load(const float* p) { return *p; }
+    static void store(float* p, reg v) { *p = v; }
+    static reg set1(float v) { return v; }
+    static reg zero() { return 0.0f; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg sub(reg a, reg b) { return a - b; }
+    static reg mul(reg a, reg b) { return a * b; }
+    static reg div(reg a, reg b) { return a / b; }
+    static reg fma(reg a, reg b, reg c) { return a * b + c; }
+    static reg max(reg a, reg b) { return a > b ? a : b; }
+    static reg min(reg a, reg b) { return a < b ? a : b; }
+    static reg sqrt(reg a) { return std::sqrt(a); }
+    static reg abs(reg a) { return std::fabs(a); }
+    static mask gt(reg a, reg b) { return a > b; }
+    static mask lt(reg a, reg b) { return a < b; }
+    static reg select(mask m, reg a, reg b) { return m ? a : b; }
+    static float hsum(reg v) { return v; }
+    static float hmax(reg v) { return v; }
+
+    static ireg cvt_f2i(reg v) { return static_cast<ireg>(std::nearbyint(v)); }
+    static reg cvt_i2f(ireg v) { return static_cast<float>(v); }
+    static ireg as_int(reg v) { ireg i; std::memcpy(&i, &v, sizeof(i)); return i; }
+    static reg as_float(ireg v) { reg f; std::memcpy(&f, &v, sizeof(f)); return f; }
+    static ireg iset1(std::int32_t v) { return v; }
+    static ireg iadd(ireg a, ireg b) { return a + b; }
+    static ireg isub(ireg a, ireg b) { return a - b; }
+    static ireg iand(ireg a, ireg b) { return a & b; }
+    static ireg ior(ireg a, ireg b) { return a | b; }
+    template <int S> static ireg slli(ireg v) { return static_cast<ireg>(static_cast<std::uint32_t>(v) << S); }
+    template <int S> static ireg srli(ireg v) { return static_cast<ireg>(static_cast<std::uint32_t>(v) >> S); }
+    static mask unord(reg a, reg b) { return std::isnan(a) || std::isnan(b); }
+
+    // bfloat16 lanes: load to the upper half of each 32-bit lane, store the low half.
+    static ireg load_bf16(const std::uint16_t* p) { return static_cast<ireg>(static_cast<std::uint32_t>(*p) << 16); }
+    static void store_bf16(std::uint16_t* p, ireg v) { *p = static_cast<std::uint16_t>(v); }
+
+    // int8 dot products: acc += sum of a[i] * b[i] over s8_width bytes, both in [-127, 127].
+    static constexpr std::size_t s8_width = 1;
+    static ireg izero() { return 0; }
+    static ireg dot_s8(ireg acc, const std::int8_t* a, const std::int8_t* b) { return acc + std::int32_t{*a} * std::int32_t{*b}; }
+    static std::int32_t ihsum(ireg v) { return v; }
+    // Bytes equal to c among the s8_width bytes at p.
+    static std::size_t count_eq(const char* p, char c) { return *p == c; }
+};
+
+// Runs f(V{}, i) over full vectors, then f(Scalar{}, i) over the tail.
+template <class V, class F>
+inline void for_each(std::size_t n, F&& f) {
+    std::size_t i = 0;
+    for (; i + V::width <= n; i += V::width) f(V{}, i);
+    for (; i < n; ++i) f(Scalar{}, i);
+}
+
+// Sum of f(.., i) over [0, n), with f returning a register of its tag's type.
+template <class V, class F>
+inline float reduce_sum(std::size_t n, F&& f) {
+    typename V::reg acc0 = V::zero();
+    typename V::reg acc1 = V::zero();
+    std::size_t i = 0;
+    for (; i + 2 * V::width <= n; i += 2 * V::width) {
+        acc0 = V::add(acc0, f(V{}, i));
+        acc1 = V::add(acc1, f(V{}, i + V::width));
+    }
+    for (; i + V::width <= n; i += V::width) {
+        acc0 = V::add(acc0, f(V{}, i));
+    }
+    float s = V::hsum(V::add(acc0, acc1));
+    for (; i < n; ++i) s += f(Scalar{}, i);
+    return s;
+}
+
+// Cephes-style expf, ~1 ulp on [-87, 88].
+template <class V>
+inline typename V::reg vexp(typename V::reg x) {
+    x = V::min(x, V::set1(88.3762626647949f));
+    x = V::max(x, V::set1(-87.3365447504f));
+    const auto n = V::cvt_f2i(V::mul(x, V::set1(1.44269504088896341f)));
+    const auto fx = V::cvt_i2f(n);
+    x = V::fma(fx, V::set1(-0.693359375f), x);
+    x = V::fma(fx, V::set1(2.12194440e-4f), x);
+
+    auto p = V::set1(1.9875691500e-4f);
+    p = V::fma(p, x, V::set1(1.3981999507e-3f));
+    p = V::fma(p, x, V::set1(8.3334519073e-3f));
+    p = V::fma(p, x, V::set1(4.1665795894e-2f));
+    p = V::fma(p, x, V::set1(1.6666665459e-1f));
+    p = V::fma(p, x, V::set1(5.0000001201e-1f));
+    const auto y = V::add(V::fma(p, V::mul(x, x), x), V::set1(1.0f));
+
+    const auto pow2n = V::as_float(V::template slli<23>(V::iadd(n, V::iset1(127))));
+    return V::mul(y, pow2n);
+}
+
+// Cephes-style logf for finite x > 0.
+template <class V>
+inline typename V::reg vlog(typename V::reg x) {
+    x = V::max(x, V::set1(1.17549435e-38f));
+    const auto bits = V::as_int(x);
+    auto e = V::cvt_i2f(V::isub(V::template srli<23>(bits), V::iset1(126)));
+    // Mantissa in [0.5, 1)
+    auto m = V::as_float(V::ior(V::iand(bits, V::iset1(0x007FFFFF)), V::iset1(0x3F000000)));
+
+    const auto small = V::lt(m, V::set1(0.707106781186547524f));
+    e = V::sub(e, V::select(small, V::set1(1.0f), V::zero()));
+    m = V::sub(V::add(m, V::select(small, m, V::zero())), V::set1(1.0f));
+
+    const auto z = V::mul(m, m);
+    auto p = V::set1(7.0376836292e-2f);
+    p = V::fma(p, m, V::set1(-1.1514610310e-1f));
+    p = V::fma(p, m, V::set1(1.1676998740e-1f));
+    p = V::fma(p, m, V::set1(-1.2420140846e-1f));
+    p = V::fma(p, m, V::set1(1.4249322787e-1f));
+    p = V::fma(p, m, V::set1(-1.6668057665e-1f));
+    p = V::fma(p, m, V::set1(2.0000714765e-1f));
+    p = V::fma(p, m, V::set1(-2.4999993993e-1f));
+    p = V::fma(p, m, V::set1(3.3333331174e-1f));
+    auto y = V::mul(V::mul(p, m), z);
+    y = V::fma(e, V::set1(-2.12194440e-4f), y);
+    y = V::fma(z, V::set1(-0.5f), y);
+    return V::fma(e, V::set1(0.693359375f), V::add(m, y));
+}
+
+template <class V, std::size_t MR, std::size_t NR>
+void gemm_micro(std::size_t kc, const float* Ap, const float* Bp,
+                float* C, std::size_t ldc, std::size_t mr, std::size_t nr, float beta) {
+    constexpr std::size_t NV = NR / V::width;
+    typename V::reg acc[MR][NV];
+    for (std::size_t i = 0; i < MR; ++i)
+        for (std::size_t j = 0; j < NV; ++j)
+            acc[i][j] = V::zero();
+
+    for (std::size_t k = 0; k < kc; ++k) {
+        typename V::reg b[NV];
+        for (std::size_t j = 0; j < NV; ++j) {
+            b[j] = V::load(Bp + k * NR + j * V::width);
+        }
+        for (std::size_t i = 0; i < MR; ++i) {
+            const auto a = V::set1(Ap[k * MR + i]);
+            for (std::size_t j = 0; j < NV; ++j) {
+                acc[i][j] = V::fma(a, b[j], acc[i][j]);
+            }
+        }
+    }
+
+    if (mr == MR && nr == NR) {
+        for (std::size_t i = 0; i < MR; ++i) {
+            for (std::size_t j = 0; j < NV; ++j) {
+                float* c = C + i * ldc + j * V::width;
+                auto r = acc[i][j];
+                if (beta != 0.0f) {
+                    r = V::fma(V::set1(beta), V::load(c), r);
+                }
+                V::store(c, r);
+            }
+        }
+        return;
+    }
+    // Edge tile
+    float tile[MR * NR];
+    for (std::size_t i = 0; i < MR; ++i)
+        for (std::size_t j = 0; j < NV; ++j)
+            V::store(tile + i * NR + j * V::width, acc[i][j]);
+    for (std::size_t i = 0; i < mr; ++i) {
+        float* c = C + i * ldc;
+        for (std::size_t j = 0; j < nr; ++j) {
+            c[j] = beta == 0.0f ? tile[i * NR + j] : beta * c[j] + tile[i * NR + j];
+        }
+    }
+}
+
+template <class V>
+void relu(const float* x, float* y, std::size_t n) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        T::store(y + i, T::max(T::load(x + i), T::zero()));
+    });
+}
+
+template <class V>
+void relu_backward(const float* x, const float* g, float* out, std::size_t n) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        T::store(out + i, T::select(T::gt(T::load(x + i), T::zero()), T::load(g + i), T::zero()));
+    });
+}
+
+template <class V>
+void step_SGD(float* w, float* g, std::size_t n, float scale) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        T::store(w + i, T::fma(T::set1(-scale), T::load(g + i), T::load(w + i)));
+        T::store(g + i, T::zero());
+    });
+}
+
+template <class V>
+void step_momentum(float* w, float* g, float* v, std::size_t n, float scale, float mu) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto vi = T::fma(T::set1(mu), T::load(v + i), T::mul(T::set1(-scale), T::load(g + i)));
+        T::store(v + i, vi);
+        T::store(w + i, T::add(T::load(w + i), vi));
+        T::store(g + i, T::zero());
+    });
+}
+
+template <class V>
+void step_RMSProp(float* w, float* g, float* r, std::size_t n, float scale, float alpha, float eps) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto gi = T::load(g + i);
+        const auto ri = T::fma(T::set1(alpha), T::load(r + i), T::mul(T::set1(1.0f - alpha), T::mul(gi, gi)));
+        T::store(r + i, ri);
+        const auto denom = T::add(T::sqrt(ri), T::set1(eps));
+        T::store(w + i, T::sub(T::load(w + i), T::div(T::mul(T::set1(scale), gi), denom)));
+        T::store(g + i, T::zero());
+    });
+}
+
+template <class V>
+void step_Adam(float* w, float* g, float* m, float* v, std::size_t n,
+               float beta1, float beta2, float scaled, float inv_bc2, float eps) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto gi = T::load(g + i);
+        const auto mi = T::fma(T::set1(beta1), T::load(m + i), T::mul(T::set1(1.0f - beta1), gi));
+        const auto vi = T::fma(T::set1(beta2), T::load(v + i), T::mul(T::set1(1.0f - beta2), T::mul(gi, gi)));
+        T::store(m + i, mi);
+        T::store(v + i, vi);
+        const auto denom = T::add(T::set1(eps), T::sqrt(T::mul(vi, T::set1(inv_bc2))));
+        T::store(w + i, T::sub(T::load(w + i), T::div(T::mul(T::set1(scaled), mi), denom)));
+        T::store(g + i, T::zero());
+    });
+}
+
+template <class V>
+void sub(const float* a, const float* b, float* out, std::size_t n) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        T::store(out + i, T::sub(T::load(a + i), T::load(b + i)));
+    });
+}
+
+// Round to nearest even like wolf::to_bf16; NaNs are kept quiet.
+template <class V>
+void cvt_to_bf16(const float* x, bf16* out, std::size_t n) {
+    auto* o = reinterpret_cast<std::uint16_t*>(out);
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto v = T::load(x + i);
+        const auto u = T::as_int(v);
+        const auto odd = T::iand(T::template srli<16>(u), T::iset1(1));
+        const auto rounded = T::template srli<16>(T::iadd(u, T::iadd(T::iset1(0x7fff), odd)));
+        const auto quiet = T::ior(T::template srli<16>(u), T::iset1(0x40));
+        T::store_bf16(o + i, T::as_int(T::select(T::unord(v, v), T::as_float(quiet), T::as_float(rounded))));
+    });
+}
+
+template <class V>
+void cvt_from_bf16(const bf16* x, float* out, std::size_t n) {
+    const auto* h = reinterpret_cast<const std::uint16_t*>(x);
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        T::store(out + i, T::as_float(T::load_bf16(h + i)));
+    });
+}
+
+// Four outputs at a time so each load of a is reused.
+template <class V>
+void dot_s8(const std::int8_t* a, const std::int8_t* B, std::size_t ldb, std::size_t n, std::size_t k, std::int32_t* out) {
+    std::size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const std::int8_t* b0 = B + j * ldb;
+        const std::int8_t* b1 = b0 + ldb;
+        const std::int8_t* b2 = b1 + ldb;
+        const std::int8_t* b3 = b2 + ldb;
+        auto acc0 = V::izero(), acc1 = V::izero(), acc2 = V::izero(), acc3 = V::izero();
+        std::size_t i = 0;
+        for (; i + V::s8_width <= k; i += V::s8_width) {
+            acc0 = V::dot_s8(acc0, a + i, b0 + i);
+            acc1 = V::dot_s8(acc1, a + i, b1 + i);
+            acc2 = V::dot_s8(acc2, a + i, b2 + i);
+            acc3 = V::dot_s8(acc3, a + i, b3 + i);
+        }
+        std::int32_t s0 = V::ihsum(acc0), s1 = V::ihsum(acc1), s2 = V::ihsum(acc2), s3 = V::ihsum(acc3);
+        for (; i < k; ++i) {
+            s0 += a[i] * b0[i];
+            s1 += a[i] * b1[i];
+            s2 += a[i] * b2[i];
+            s3 += a[i] * b3[i];
+        }
+        out[j] = s0; out[j + 1] = s1; out[j + 2] = s2; out[j + 3] = s3;
+    }
+    for (; j < n; ++j) {
+        const std::int8_t* b = B + j * ldb;
+        auto acc = V::izero();
+        std::size_t i = 0;
+        for (; i + V::s8_width <= k; i += V::s8_width) {
+            acc = V::dot_s8(acc, a + i, b + i);
+        }
+        std::int32_t s = V::ihsum(acc);
+        for (; i < k; ++i) {
+            s += a[i] * b[i];
+        }
+        out[j] = s;
+    }
+}
+
+template <class V>
+std::size_t count_byte(const char* p, std::size_t n, char c) {
+    std::size_t count = 0;
+    std::size_t i = 0;
+    for (; i + V::s8_width <= n; i += V::s8_width) {
+        count += V::count_eq(p + i, c);
+    }
+    for (; i < n; ++i) {
+        count += p[i] == c;
+    }
+    return count;
+}
+
+template <class V>
+void accumulate(float* dst, float* src, std::size_t n) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        T::store(dst + i, T::add(T::load(dst + i), T::load(src + i)));
+        T::store(src + i, T::zero());
+    });
+}
+
+template <class V>
+float sum(const float* x, std::size_t n) {
+    return reduce_sum<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        return T::load(x + i);
+    });
+}
+
+template <class V>
+float max(const float* x, std::size_t n) {
+    if (n == 0) {
+        return -INFINITY;
+    }
+    std::size_t i = 0;
+    float m = x[0];
+    if (n >= V::width) {
+        auto acc = V::load(x);
+        for (i = V::width; i + V::width <= n; i += V::width) {
+            acc = V::max(acc, V::load(x + i));
+        }
+        m = V::hmax(acc);
+    }
+    for (; i < n; ++i) m = x[i] > m ? x[i] : m;
+    return m;
+}
+
+template <class V>
+float dot(const float* a, const float* b, std::size_t n) {
+    return reduce_sum<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        return T::mul(T::load(a + i), T::load(b + i));
+    });
+}
+
+template <class V>
+float half_sq_diff_sum(const float* a, const float* b, std::size_t n) {
+    return 0.5f * reduce_sum<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto d = T::sub(T::load(a + i), T::load(b + i));
+        return T::mul(d, d);
+    });
+}
+
+template <class V>
+float exp_shift_sum(const float* x, float shift, float* out, std::size_t n) {
+    if (out == nullptr) {
+        return reduce_sum<V>(n, [&](auto t, std::size_t i) {
+            using T = decltype(t);
+            return vexp<T>(T::sub(T::load(x + i), T::set1(shift)));
+        });
+    }
+    return reduce_sum<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto e = vexp<T>(T::sub(T::load(x + i), T::set1(shift)));
+        T::store(out + i, e);
+        return e;
+    });
+}
+
+template <class V>
+void scale_sub(const float* x, float s, const float* b, float* out, std::size_t n) {
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        T::store(out + i, T::fma(T::load(x + i), T::set1(s), T::sub(T::zero(), T::load(b + i))));
+    });
+}
+
+template <class V>
+void sigmoid_sub(const float* z, const float* b, float* out, std::size_t n) {
+    // sigmoid(z) = 1 / (1 + exp(-z)); exp(-|z|) keeps it finite for large |z|
+    for_each<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto zi = T::load(z + i);
+        const auto e = vexp<T>(T::sub(T::zero(), T::abs(zi)));
+        const auto inv = T::div(T::set1(1.0f), T::add(T::set1(1.0f), e));
+        const auto y = T::select(T::lt(zi, T::zero()), T::mul(e, inv), inv);
+        T::store(out + i, T::sub(y, T::load(b + i)));
+    });
+}
+
+template <class V>
+float bce_with_logits_sum(const float* z, const float* b, std::size_t n) {
+    // max(z, 0) - z * b + log(1 + exp(-|z|))
+    return reduce_sum<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto zi = T::load(z + i);
+        const auto e = vexp<T>(T::sub(T::zero(), T::abs(zi)));
+        const auto l = vlog<T>(T::add(T::set1(1.0f), e));
+        return T::add(T::sub(T::max(zi, T::zero()), T::mul(zi, T::load(b + i))), l);
+    });
+}
+
+template <class V>
+float sub_half_sq_sum(const float* a, const float* b, float* out, std::size_t n) {
+    return 0.5f * reduce_sum<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto d = T::sub(T::load(a + i), T::load(b + i));
+        T::store(out + i, d);
+        return T::mul(d, d);
+    });
+}
+
+template <class V>
+float bce_with_logits_grad(const float* z, const float* b, float* out, std::size_t n) {
+    // Loss and sigmoid share exp(-|z|)
+    return reduce_sum<V>(n, [&](auto t, std::size_t i) {
+        using T = decltype(t);
+        const auto zi = T::load(z + i);
+        const auto bi = T::load(b + i);
+        const auto e = vexp<T>(T::sub(T::zero(), T::abs(zi)));
+        const auto one_e = T::add(T::set1(1.0f), e);
+        const auto inv = T::div(T::set1(1.0f), one_e);
+        const auto y = T::select(T::lt(zi, T::zero()), T::mul(e, inv), inv);
+        T::store(out + i, T::sub(y, bi));
+        return T::add(T::sub(T::max(zi, T::zero()), T::mul(zi, bi)), vlog<T>(one_e));
+    });
+}
+
+template <class V, std::size_t MR, std::size_t NR>
+Kernels make_kernels(Isa isa) {
+    Kernels k{};
+    k.isa = isa;
+    k.gemm = {MR, NR, &gemm_micro<V, MR, NR>};
+    k.relu = &relu<V>;
+    k.relu_backward = &relu_backward<V>;
+    k.step_SGD = &step_SGD<V>;
+    k.step_momentum = &step_momentum<V>;
+    k.step_RMSProp = &step_RMSProp<V>;
+    k.step_Adam = &step_Adam<V>;
+    k.sub = &sub<V>;
+    k.accumulate = &accumulate<V>;
+    k.to_bf16 = &cvt_to_bf16<V>;
+    k.from_bf16 = &cvt_from_bf16<V>;
+    k.dot_s8 = &dot_s8<V>;
+    k.count_byte = &count_byte<V>;
+    k.sum = &sum<V>;
+    k.max = &max<V>;
+    k.dot = &dot<V>;
+    k.half_sq_diff_sum = &half_sq_diff_sum<V>;
+    k.exp_shift_sum = &exp_shift_sum<V>;
+    k.scale_sub = &scale_sub<V>;
+    k.sigmoid_sub = &sigmoid_sub<V>;
+    k.bce_with_logits_sum = &bce_with_logits_sum<V>;
+    k.sub_half_sq_sum = &sub_half_sq_sum<V>;
+    k.bce_with_logits_grad = &bce_with_logits_grad<V>;
+    return k;
+}
+
+}
+}
@@ -0,0 +1,9 @@
+// Portable fallback; the compiler may still auto-vectorize for the baseline target.
+#include <math/simd/kernels.h>
+
+namespace wolf::simd {
+    const Kernels& scalar_kernels() {
+        static const Kernels k = make_kernels<Scalar, 4, 8>(Isa::Scalar);
+        return k;
+    }
+}
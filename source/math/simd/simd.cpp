@@ -0,0 +1,127 @@
+#include <math/simd/simd.h>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(WOLF_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace wolf::simd {
+    // Defined in the per-ISA translation units.
+    const Kernels& scalar_kernels();
+#if defined(WOLF_SIMD_X86)
+    const Kernels& sse2_kernels();
+    const Kernels& avx2_kernels();
+    const Kernels& avx512_kernels();
+    const Kernels& avx512_vnni_kernels();
+#endif
+
+    namespace {
+#if defined(WOLF_SIMD_X86)
+        void cpuid(int out[4], int leaf, int sub) {
+#if defined(_MSC_VER)
+            __cpuidex(out, leaf, sub);
+#else
+            unsigned a, b, c, d;
+            __cpuid_count(leaf, sub, a, b, c, d);
+            out[0] = static_cast<int>(a); out[1] = static_cast<int>(b);
+            out[2] = static_cast<int>(c); out[3] = static_cast<int>(d);
+#endif
+        }
+
+        // Register state the OS saves on context switch (XCR0).
+        unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+            return _xgetbv(0);
+#else
+            unsigned a, d;
+            __asm__ volatile("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+            return (static_cast<unsigned long long>(d) << 32) | a;
+#endif
+        }
+
+        Isa detect() {
+            int r[4];
+            cpuid(r, 0, 0);
+            const int max_leaf = r[0];
+            cpuid(r, 1, 0);
+            const bool osxsave = r[2] & (1 << 27);
+            const bool avx = r[2] & (1 << 28);
+            const bool fma = r[2] & (1 << 12);
+            if (!osxsave || !avx) {
+                return Isa::SSE2;
+            }
+            const unsigned long long xcr0 = xgetbv0();
+            const bool os_avx = (xcr0 & 0x6) == 0x6;        // XMM, YMM
+            const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;   // + opmask, ZMM
+            if (!os_avx || max_leaf < 7) {
+                return Isa::SSE2;
+            }
+            cpuid(r, 7, 0);
+            const bool avx2 = r[1] & (1 << 5);
+            const bool avx512 = (r[1] & (1 << 16)) && (r[1] & (1 << 17))   // F, DQ
+                             && (r[1] & (1 << 30)) && (r[1] & (1u << 31)); // BW, VL
+            if (avx512 && os_avx512 && fma) {
+                return Isa::AVX512;
+            }
+            if (avx2 && fma) {
+                return Isa::AVX2;
+            }
+            return Isa::SSE2;
+        }
+
+        // Only asked once AVX-512 itself is known to be usable.
+        bool has_avx512_vnni() {
+            int r[4];
+            cpuid(r, 7, 0);
+            return r[2] & (1 << 11);
+        }
+#else
+        Isa detect() {
+            return Isa::Scalar;
+        }
+#endif
+
+        Isa requested_cap() {
+            const char* env = std::getenv("WOLF_SIMD");
+            if (env == nullptr) return Isa::AVX512;
+            if (std::strcmp(env, "scalar") == 0) return Isa::Scalar;
+            if (std::strcmp(env, "sse2") == 0) return Isa::SSE2;
+            if (std::strcmp(env, "avx2") == 0) return Isa::AVX2;
+            return Isa::AVX512;
+        }
+
+        const Kernels& select() {
+            const Isa cap = requested_cap();
+            const Isa found = detect();
+            const Isa isa = found < cap ? found : cap;
+            switch (isa) {
+#if defined(WOLF_SIMD_X86)
+            case Isa::AVX512: return has_avx512_vnni() ? avx512_vnni_kernels() : avx512_kernels();
+            case Isa::AVX2:   return avx2_kernels();
+            case Isa::SSE2:   return sse2_kernels();
+#endif
+            default:          return scalar_kernels();
+            }
+        }
+    }
+
+    const Kernels& kernels() {
+        static const Kernels& k = select();
+        return k;
+    }
+
+    const char* isa_name(Isa isa) {
+        switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE2:   return "sse2";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+        }
+        return "unknown";
+    }
+}
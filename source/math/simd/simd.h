@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <math/bf16.h>
+
+namespace wolf::simd {
+
+enum class Isa : uint8_t {
+    Scalar,
+    SSE2,
+    AVX2,   // AVX2 + FMA
+    AVX512, // AVX-512 F/BW/DQ/VL
+};
+
+// Register-tiled GEMM micro-kernel: C[mr x nr] = Ap * Bp + beta * C.
+// Ap holds kc columns of MR packed rows, Bp kc rows of NR packed columns.
+struct GemmMicroKernel {
+    std::size_t mr;
+    std::size_t nr;
+    void (*run)(std::size_t kc, const float* Ap, const float* Bp,
+                float* C, std::size_t ldc, std::size_t mr, std::size_t nr, float beta);
+};
+
+// One table per instruction set. All pointers are always set.
+struct Kernels {
+    Isa isa;
+    GemmMicroKernel gemm;
+
+    // Activations
+    void (*relu)(const float* x, float* y, std::size_t n);
+    void (*relu_backward)(const float* x, const float* g, float* out, std::size_t n); // out = x > 0 ? g : 0
+
+    // Optimizer updates, gradients are zeroed after use
+    void (*step_SGD)(float* w, float* g, std::size_t n, float scale);
+    void (*step_momentum)(float* w, float* g, float* v, std::size_t n, float scale, float mu);
+    void (*step_RMSProp)(float* w, float* g, float* r, std::size_t n, float scale, float alpha, float eps);
+    void (*step_Adam)(float* w, float* g, float* m, float* v, std::size_t n,
+                      float beta1, float beta2, float scaled, float inv_bc2, float eps);
+
+    // Precision conversion
+    void (*to_bf16)(const float* x, bf16* out, std::size_t n); // Round to nearest even
+    void (*from_bf16)(const bf16* x, float* out, std::size_t n);
+
+    // int8 inference: out[j] = sum_i a[i] * B[j * ldb + i] for j < n, i < k.
+    // Exact for a and B in [-127, 127].
+    void (*dot_s8)(const std::int8_t* a, const std::int8_t* B, std::size_t ldb,
+                   std::size_t n, std::size_t k, std::int32_t* out);
+
+    // Text parsing: number of bytes of p[0, n) equal to c
+    std::size_t (*count_byte)(const char* p, std::size_t n, char c);
+
+    // Loss building blocks
+    void  (*sub)(const float* a, const float* b, float* out, std::size_t n);
+    void  (*accumulate)(float* dst, float* src, std::size_t n); // dst += src, then src = 0
+    float (*sum)(const float* x, std::size_t n);
+    float (*max)(const float* x, std::size_t n);
+    float (*dot)(const float* a, const float* b, std::size_t n);
+    float (*half_sq_diff_sum)(const float* a, const float* b, std::size_t n);    // sum 0.5 * (a - b)^2
+    float (*exp_shift_sum)(const float* x, float shift, float* out, std::size_t n); // out = exp(x - shift), returns sum; out may be null
+    void  (*scale_sub)(const float* x, float s, const float* b, float* out, std::size_t n); // out = x * s - b
+    void  (*sigmoid_sub)(const float* z, const float* b, float* out, std::size_t n);
+    float (*bce_with_logits_sum)(const float* z, const float* b, std::size_t n);
+
+    // Fused loss + gradient: write the gradient to out, return the summed loss
+    float (*sub_half_sq_sum)(const float* a, const float* b, float* out, std::size_t n);      // out = a - b
+    float (*bce_with_logits_grad)(const float* z, const float* b, float* out, std::size_t n); // out = sigmoid(z) - b
+};
+
+// Best table for this CPU, chosen once on first use.
+// The environment variable WOLF_SIMD=scalar|sse2|avx2|avx512 caps the choice.
+// On AVX-512 CPUs with VNNI the int8 kernel uses it.
+const Kernels& kernels();
+
+const char* isa_name(Isa isa);
+
+}
@@ -0,0 +1,92 @@
+#include <math/simd/kernels.h>
+#include <immintrin.h>
+
+namespace wolf::simd {
+namespace {
+
+struct Sse2 {
+    using reg = __m128;
+    using ireg = __m128i;
+    using mask = __m128;
+    static constexpr std::size_t width = 4;
+
+    static reg load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, reg v) { _mm_storeu_ps(p, v); }
+    static reg set1(float v) { return _mm_set1_ps(v); }
+    static reg zero() { return _mm_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+    static reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+    static reg fma(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+    static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+    static reg sqrt(reg a) { return _mm_sqrt_ps(a); }
+    static reg abs(reg a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static mask gt(reg a, reg b) { return _mm_cmpgt_ps(a, b); }
+    static mask lt(reg a, reg b) { return _mm_cmplt_ps(a, b); }
+    static reg select(mask m, reg a, reg b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static float hsum(reg v) {
+        v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+    static float hmax(reg v) {
+        v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+
+    static ireg cvt_f2i(reg v) { return _mm_cvtps_epi32(v); }
+    static reg cvt_i2f(ireg v) { return _mm_cvtepi32_ps(v); }
+    static ireg as_int(reg v) { return _mm_castps_si128(v); }
+    static reg as_float(ireg v) { return _mm_castsi128_ps(v); }
+    static ireg iset1(std::int32_t v) { return _mm_set1_epi32(v); }
+    static ireg iadd(ireg a, ireg b) { return _mm_add_epi32(a, b); }
+    static ireg isub(ireg a, ireg b) { return _mm_sub_epi32(a, b); }
+    static ireg iand(ireg a, ireg b) { return _mm_and_si128(a, b); }
+    static ireg ior(ireg a, ireg b) { return _mm_or_si128(a, b); }
+    template <int S> static ireg slli(ireg v) { return _mm_slli_epi32(v, S); }
+    template <int S> static ireg srli(ireg v) { return _mm_srli_epi32(v, S); }
+    static mask unord(reg a, reg b) { return _mm_cmpunord_ps(a, b); }
+
+    static ireg load_bf16(const std::uint16_t* p) {
+        return _mm_unpacklo_epi16(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+    static void store_bf16(std::uint16_t* p, ireg v) {
+        // Sign-extend the low halves so the saturating signed pack is exact (no packus_epi32 in SSE2)
+        const __m128i s = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(s, s));
+    }
+
+    // No maddubs before SSSE3: sign-extend to 16 bits and use madd.
+    static constexpr std::size_t s8_width = 16;
+    static ireg izero() { return _mm_setzero_si128(); }
+    static ireg dot_s8(ireg acc, const std::int8_t* a, const std::int8_t* b) {
+        const __m128i av = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        const __m128i bv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        const __m128i a_lo = _mm_srai_epi16(_mm_unpacklo_epi8(av, av), 8);
+        const __m128i a_hi = _mm_srai_epi16(_mm_unpackhi_epi8(av, av), 8);
+        const __m128i b_lo = _mm_srai_epi16(_mm_unpacklo_epi8(bv, bv), 8);
+        const __m128i b_hi = _mm_srai_epi16(_mm_unpackhi_epi8(bv, bv), 8);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(a_lo, b_lo));
+        return _mm_add_epi32(acc, _mm_madd_epi16(a_hi, b_hi));
+    }
+    static std::int32_t ihsum(ireg v) {
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(v);
+    }
+    static std::size_t count_eq(const char* p, char c) {
+        const __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi8(c));
+        return std::popcount(static_cast<unsigned>(_mm_movemask_epi8(eq)));
+    }
+};
+
+}
+
+    const Kernels& sse2_kernels() {
+        static const Kernels k = make_kernels<Sse2, 6, 8>(Isa::SSE2);
+        return k;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace wolf {
+
+// A batch of sparse rows in CSR form: the non-zeros of row r are values[i] at column
+// col_idx[i] for i in [row_ptr[r], row_ptr[r + 1]). Columns need not be sorted; repeated
+// columns add up. Views memory owned by the caller, like TensorView.
+struct SparseView {
+    const size_t* row_ptr = nullptr; // [rows + 1]
+    const uint32_t* col_idx = nullptr;
+    const float* values = nullptr;
+    size_t rows = 0, cols = 0;
+
+    size_t nnz() const { return rows == 0 ? 0 : row_ptr[rows] - row_ptr[0]; }
+    // Rows [r0, r1) as a batch of their own; nothing is copied.
+    SparseView slice(size_t r0, size_t r1) const { return {row_ptr + r0, col_idx, values, r1 - r0, cols}; }
+};
+
+// A batch of integer ids, cols per row (one per categorical field, say), row-major.
+// Views memory owned by the caller.
+struct IndexView {
+    const uint32_t* ids = nullptr;
+    size_t rows = 0, cols = 0;
+
+    size_t nnz() const { return rows * cols; }
+};
+
+// Owning CSR batch, built row by row.
+class SparseTensor {
+public:
+    explicit SparseTensor(size_t cols) : cols(cols) {}
+
+    void add_row(std::span<const uint32_t> idx, std::span<const float> vals) {
+        if (idx.size() != vals.size()) {
+            throw std::runtime_error("SparseTensor::add_row: index and value counts differ");
+        }
+        for (uint32_t c : idx) {
+            if (c >= cols) {
+                throw std::runtime_error("SparseTensor::add_row: column out of range");
+            }
+        }
+        col_idx.insert(col_idx.end(), idx.begin(), idx.end());
+        values.insert(values.end(), vals.begin(), vals.end());
+        row_ptr.push_back(col_idx.size());
+    }
+    void clear() {
+        row_ptr.assign(1, 0);
+        col_idx.clear();
+        values.clear();
+    }
+    size_t nrows() const { return row_ptr.size() - 1; }
+    size_t ncols() const { return cols; }
+    size_t nnz() const { return col_idx.size(); }
+    SparseView view() const { return {row_ptr.data(), col_idx.data(), values.data(), nrows(), cols}; }
+
+private:
+    std::vector<size_t> row_ptr{0};
+    std::vector<uint32_t> col_idx;
+    std::vector<float> values;
+    size_t cols;
+};
+
+}
@@ -1,36 +1,46 @@
 #pragma once
 #include <vector>
 #include <print>
+#include <math/aligned.h>
 namespace wolf {
 
 
 
+// Row-major matrix in tensor_alignment aligned storage. Rows are ld() floats apart, cols
+// unless constructed with a padded leading dimension (see padded_ld).
 class Tensor {
 private:
-    std::vector<float> data_;
+    AlignedVector data_;
     size_t rows{0};
     size_t cols{0};
+    size_t ld_{0};
 public:
     Tensor() = default;
+    // rows x cols zeros, rows ld apart (at least cols).
+    Tensor(size_t r, size_t c, size_t ld = 0)
+        : data_(r * std::max(ld, c)), rows(r), cols(c), ld_(std::max(ld, c)) {}
     Tensor(const std::vector<float>& v, size_t r, size_t c)
-        : data_(v), rows(r), cols(c) {}
-    Tensor(std::vector<float>&& v, size_t r, size_t c)
-        : data_(std::move(v)), rows(r), cols(c) {}    
+        : data_(v.begin(), v.end()), rows(r), cols(c), ld_(c) {}
+    Tensor(AlignedVector&& v, size_t r, size_t c)
+        : data_(std::move(v)), rows(r), cols(c), ld_(c) {}
     Tensor(const std::vector<std::vector<float>>& input);
     size_t nrows() const {return rows;}
     size_t ncols() const {return cols;}
+    size_t ld() const {return ld_;}
+    // Reshape without moving data; the tensor is then contiguous (ld = cols).
     void set_rows(size_t r) {rows = r;}
-    void set_cols(size_t c) {cols = c;}
+    void set_cols(size_t c) {cols = c; ld_ = c;}
 
+    // The storage, rows * ld() floats
     template <class Self>
     auto&& data(this Self&& self) {
         return std::forward<Self>(self).data_;
     }
     inline float operator()(size_t r, size_t c) const {
-        return data_[static_cast<std::size_t>(r) * cols + c];
+        return data_[static_cast<std::size_t>(r) * ld_ + c];
     };
     inline float& operator()(size_t r, size_t c) {
-        return data_[r * cols + c];
+        return data_[r * ld_ + c];
     }
     inline float operator()(size_t i) const {
         return data_[i];
@@ -51,23 +61,66 @@ public:
         return rows * cols;
     }
 };
- 
 
+
+// Matrix in memory owned by someone else; element (r, c) is data[r * stride + c * col_stride].
+// Views of Tensors and planned buffers are row-major (col_stride 1, stride >= cols); t() of
+// one is column-major (stride 1). Slices keep the layout, so one of the strides is always 1.
+// Layers read inputs of either layout and write row-major outputs of any stride.
 struct TensorView {
     float* data;
     size_t rows, cols;
+    size_t stride;         // Floats from one row to the next
+    size_t col_stride = 1; // Floats from one column to the next
+
+    TensorView() : data(nullptr), rows(0), cols(0), stride(0) {}
+    TensorView(float* data, size_t rows, size_t cols) : data(data), rows(rows), cols(cols), stride(cols) {}
+    TensorView(float* data, size_t rows, size_t cols, size_t stride, size_t col_stride = 1)
+        : data(data), rows(rows), cols(cols), stride(stride), col_stride(col_stride) {}
+    TensorView(Tensor& input) : data(input.data().data()), rows(input.nrows()), cols(input.ncols()), stride(input.ld()) {}
+
+    size_t size() const { return rows * cols; }
+    bool row_major() const { return col_stride == 1; }
+    // No gaps: flat index i is element (i / cols, i % cols).
+    bool contiguous() const { return col_stride == 1 && (stride == cols || rows <= 1); }
+    // Row r of a row-major view.
+    float* row(size_t r) const { return data + r * stride; }
 
-    TensorView(float* data, size_t rows, size_t cols) : data(data), rows(rows), cols(cols) {}
-    TensorView(Tensor& input) : data(input.data().data()), rows(input.nrows()), cols(input.ncols()) {}
+    TensorView slice_rows(size_t r0, size_t r1) const { return {data + r0 * stride, r1 - r0, cols, stride, col_stride}; }
+    TensorView slice_cols(size_t c0, size_t c1) const { return {data + c0 * col_stride, rows, c1 - c0, stride, col_stride}; }
+    TensorView t() const { return {data, cols, rows, col_stride, stride}; }
 
+    // Flat index, for contiguous views.
     float& operator()(std::size_t i)       { return data[i]; }
     float  operator()(std::size_t i) const { return data[i]; }
 
     float& operator()(std::size_t r, std::size_t c) {
-        return data[r * cols + c];
+        return data[r * stride + c * col_stride];
     }
     float operator()(std::size_t r, std::size_t c) const {
-        return data[r * cols + c];
+        return data[r * stride + c * col_stride];
     }
 };
+
+// Element-wise copy between views of the same shape, any layouts.
+inline void copy_view(const TensorView& src, TensorView dst) {
+    for (size_t r = 0; r < src.rows; ++r) {
+        for (size_t c = 0; c < src.cols; ++c) {
+            dst(r, c) = src(r, c);
+        }
+    }
+}
+
+// v if it is row-major, else a contiguous copy of it in tmp: for the code paths that walk rows.
+inline TensorView row_major(const TensorView& v, AlignedVector& tmp) {
+    if (v.row_major()) {
+        return v;
+    }
+    if (tmp.size() < v.size()) {
+        tmp.resize(v.size());
+    }
+    TensorView copy{tmp.data(), v.rows, v.cols};
+    copy_view(v, copy);
+    return copy;
+}
 }
@@ -0,0 +1,46 @@
+#include <model/ArenaLayer.h>
+#include <math/simd/simd.h>
+
+namespace wolf {
+    void ArenaLayer::bind_params(ParamArena& target, size_t offset) {
+        if (&target != arena || offset != arena_offset) {
+            target.copy_slot(*arena, arena_offset, offset, param_count());
+        }
+        view_params(target, offset);
+        own_params.reset();
+    }
+
+    void ArenaLayer::step_SGD(float lr, size_t batch_size) {
+        const float scale = lr / static_cast<float>(batch_size);
+        const auto& k = simd::kernels();
+        float* w = slot(ParamArena::Params);
+        float* g = slot(ParamArena::Grads);
+        for_each_update([&](size_t i, size_t n) {
+            k.step_SGD(w + i, g + i, n, scale);
+        });
+    }
+
+    void ArenaLayer::step_momentum(float lr, float mu, size_t batch_size) {
+        const float scale = lr / static_cast<float>(batch_size);
+        const auto& k = simd::kernels();
+        float* w = slot(ParamArena::Params);
+        float* g = slot(ParamArena::Grads);
+        float* v = slot(ParamArena::Moment1);
+        for_each_update([&](size_t i, size_t n) {
+            k.step_momentum(w + i, g + i, v + i, n, scale, mu);
+        });
+    }
+
+    void ArenaLayer::step_RMSProp(float lr, float alpha, float eps, size_t batch_size) {
+        const float scale = lr / static_cast<float>(batch_size);
+        const auto& k = simd::kernels();
+        float* w = slot(ParamArena::Params);
+        float* g = slot(ParamArena::Grads);
+        float* r = slot(ParamArena::Moment2);
+        for_each_update([&](size_t i, size_t n) {
+            k.step_RMSProp(w + i, g + i, r + i, n, scale, alpha, eps);
+        });
+    }
+
+    // Step Adam in AdamStepper.cpp due to floating math restrictions
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <model/Layer.h>
+#include <model/ParamArena.h>
+#include <model/RowSparseGrad.h>
+#include <memory>
+
+namespace wolf {
+
+// A layer whose parameters fill one param_count()-float slot of a ParamArena, an arena of
+// its own until Sequential binds it into the model's. Each such layer also has a
+// constructor (shape..., ParamArena& arena, size_t offset) that views parameters already
+// at arena[offset, ...) instead of creating new ones. The optimizers update the whole
+// slot, or only the rows touched_rows() lists.
+class ArenaLayer : public Layer {
+public:
+    void step_SGD(float lr, size_t batch_size) override;
+    void step_momentum(float lr, float mu, size_t batch_size) override;
+    void step_RMSProp(float lr, float alpha, float eps, size_t batch_size) override;
+    void step_Adam(float lr, float beta1, float beta2, float eps, float bc1, float bc2, size_t batch_size) override;
+
+    // Also used to re-view the same slot after the arena allocated missing regions.
+    void bind_params(ParamArena& target, size_t offset) override;
+
+protected:
+    using Layer::Layer;
+    // For the constructor that creates the parameters: a new arena of param_count() floats.
+    void own_slot() {
+        own_params = std::make_unique<ParamArena>(param_count());
+        view_params(*own_params, 0);
+    }
+    // Points the layer's tensors at target[offset, ...).
+    virtual void view_params(ParamArena& target, size_t offset) = 0;
+    // Region r of the slot, null where the arena has none.
+    float* slot(ParamArena::Region r) const {
+        float* p = arena->region(r);
+        return p != nullptr ? p + arena_offset : nullptr;
+    }
+
+    ParamArena* arena = nullptr;
+    size_t arena_offset = 0;
+
+private:
+    // fn(offset, n) over the slot ranges the next update covers, then marks them updated.
+    template <class F>
+    void for_each_update(F&& fn) {
+        for_each_update_range(touched_rows(), param_count(), fn);
+        params_changed();
+    }
+
+    std::unique_ptr<ParamArena> own_params; // Until bound into a model-wide arena
+};
+
+}
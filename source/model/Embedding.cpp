@@ -0,0 +1,74 @@
+#include <model/Embedding.h>
+#include <math/rng.h>
+#include <math/simd/simd.h>
+#include <algorithm>
+#include <string>
+
+namespace wolf {
+    namespace {
+        // Batch rows per forward task
+        constexpr size_t row_grain = 16;
+    }
+
+    EmbeddingLayer::EmbeddingLayer(size_t vocab, size_t dim) : ArenaLayer(LayerKind::Embedding), vocab(vocab), dim(dim) {
+        own_slot();
+
+        auto& gen = rng().gen;
+        auto normal_gen = [&]() {return std::normal_distribution<float>{0.0f, 1.0f}(gen);};
+        std::generate_n(E.data, E.size(), normal_gen);
+    }
+
+    EmbeddingLayer::EmbeddingLayer(size_t vocab, size_t dim, ParamArena& arena, size_t offset)
+            : ArenaLayer(LayerKind::Embedding), vocab(vocab), dim(dim) {
+        view_params(arena, offset);
+    }
+
+    void EmbeddingLayer::view_params(ParamArena& target, size_t offset) {
+        arena = &target;
+        arena_offset = offset;
+        E  = target.view(ParamArena::Params,  offset, vocab, dim);
+        dE = target.view(ParamArena::Grads,   offset, vocab, dim);
+    }
+
+    void EmbeddingLayer::forward_indices(const IndexView& x, TensorView out) {
+        // Before any task writes out, and out of the copy loop
+        const uint32_t* bad = std::find_if(x.ids, x.ids + x.rows * x.cols, [&](uint32_t id) { return id >= vocab; });
+        if (bad != x.ids + x.rows * x.cols) {
+            throw std::runtime_error("EmbeddingLayer: id " + std::to_string(*bad)
+                                     + " out of range for a vocabulary of " + std::to_string(vocab));
+        }
+        runtime::parallel_for(x.rows, row_grain, [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; ++r) {
+                const uint32_t* ids = x.ids + r * x.cols;
+                for (size_t f = 0; f < x.cols; ++f) {
+                    std::copy_n(E.data + size_t{ids[f]} * dim, dim, out.row(r) + f * dim);
+                }
+            }
+        });
+        last_ids = grad_enabled ? x : IndexView{};
+    }
+
+    // Each id's slice of grad_out goes to its row; repeated ids add up.
+    void EmbeddingLayer::backward_sparse(const TensorView& grad_out) {
+        const TensorView g = row_major(grad_out, grad_rows);
+        for (size_t r = 0; r < last_ids.rows; ++r) {
+            const uint32_t* ids = last_ids.ids + r * last_ids.cols;
+            for (size_t f = 0; f < last_ids.cols; ++f) {
+                sparse_dE.add(ids[f], g.row(r) + f * dim, 1.0f);
+            }
+        }
+        sparse_dE.accumulate(dE.data, dim);
+    }
+
+    SparseRows EmbeddingLayer::touched_rows() const {
+        return {sparse_dE.touched(), dim, param_count()};
+    }
+
+    LayerCost EmbeddingLayer::sparse_cost(runtime::Phase phase, size_t, size_t nnz) const {
+        const double n = static_cast<double>(nnz);
+        if (phase == runtime::Phase::Forward) {
+            return {0.0, n * (8.0 * dim + 4.0)};
+        }
+        return {n * dim, n * (12.0 * dim + 4.0)};
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <math/tensor.h>
+#include <math/sparse.h>
+#include <model/ArenaLayer.h>
+#include <model/RowSparseGrad.h>
+#include <external/zpp_bits.h>
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+
+namespace wolf {
+
+// Lookup table for categorical ids: a batch of [B x fields] ids (IndexView) becomes
+// [B x fields * dim], the rows of the ids side by side. Backward accumulates into the
+// looked-up rows only, and the optimizers update only those (lazily: moments of other
+// rows are left as they are), so a step costs O(batch) whatever the vocabulary.
+// Only takes index input, so it is always a model's first layer.
+class EmbeddingLayer : public ArenaLayer {
+public:
+    EmbeddingLayer(size_t vocab, size_t dim);
+    EmbeddingLayer(size_t vocab, size_t dim, ParamArena& arena, size_t offset);
+
+    size_t out_cols(size_t in_cols) const override { return in_cols * dim; }
+    void forward_into(const TensorView&, TensorView) override {
+        throw std::logic_error("EmbeddingLayer takes index input (Sequential::pred(const IndexView&))");
+    }
+    void infer(const TensorView&, TensorView, InferenceContext&) const override {
+        throw std::logic_error("EmbeddingLayer takes index input (Sequential::pred(const IndexView&))");
+    }
+    void backward_into(const TensorView&, TensorView) override {
+        throw std::logic_error("EmbeddingLayer takes index input (Sequential::pred(const IndexView&))");
+    }
+    void forward_indices(const IndexView& x, TensorView out) override;
+    void backward_sparse(const TensorView& grad_out) override;
+    SparseRows touched_rows() const override;
+    void params_changed() override { sparse_dE.clear_touched(); }
+
+    LayerCost sparse_cost(runtime::Phase phase, size_t rows, size_t nnz) const override;
+    size_t vocab_size() const {return vocab;}
+    size_t embedding_dim() const {return dim;}
+    size_t param_count() const override { return align_floats(vocab * dim); }
+    std::unique_ptr<Layer> replicate(ParamArena& arena, size_t offset) const override {
+        return std::make_unique<EmbeddingLayer>(vocab, dim, arena, offset);
+    }
+    void save_body(zpp::bits::out<std::vector<std::byte>>& out) const override {
+        out(vocab, dim, std::span<const float>(E.data, E.size())).or_throw();
+    }
+    void save_shape(zpp::bits::out<std::vector<std::byte>>& out) const override {
+        out(vocab, dim).or_throw();
+    }
+    const float* param_data() const override { return E.data; }
+    static std::unique_ptr<Layer> load_view(zpp::bits::in<std::vector<std::byte>>& in, ParamArena& arena, size_t offset) {
+        std::size_t vocab{}, dim{};
+        in(vocab, dim).or_throw();
+        return std::make_unique<EmbeddingLayer>(vocab, dim, arena, offset);
+    }
+    static std::unique_ptr<Layer> load_from(zpp::bits::in<std::vector<std::byte>>& in) {
+        std::size_t vocab{}, dim{};
+        std::vector<float> Ev;
+        in(vocab, dim, Ev).or_throw();
+        if (Ev.size() != vocab * dim) {
+            throw std::runtime_error("EmbeddingLayer::load_from: table size mismatch");
+        }
+        auto layer = std::make_unique<EmbeddingLayer>(vocab, dim);
+        std::ranges::copy(Ev, layer->E.data);
+        return layer;
+    }
+
+private:
+    void view_params(ParamArena& target, size_t offset) override;
+
+    size_t vocab;
+    size_t dim;
+    // Views into arena
+    TensorView E;  // [vocab x dim]
+    TensorView dE;
+    IndexView last_ids; // Owned by the caller
+    AlignedVector grad_rows; // A column-major grad_out gathered into rows
+    RowSparseGrad sparse_dE;
+};
+
+}
@@ -0,0 +1,42 @@
+#include <model/FusedLinearReLU.h>
+#include <math/parallel.h>
+#include <algorithm>
+
+namespace wolf {
+    void FusedLinearReLU::forward_into(const TensorView& x, TensorView out) {
+        if (!grad_enabled) {
+            linear.forward_fused(x, out, Activation::ReLU, nullptr);
+            return;
+        }
+        const size_t n = x.rows * linear.out_size();
+        if (mask.size() < n) {
+            mask.resize(n);
+        }
+        linear.forward_fused(x, out, Activation::ReLU, mask.data());
+    }
+
+    void FusedLinearReLU::backward_into(const TensorView& grad_out, TensorView grad_in) {
+        const size_t rows = grad_out.rows, cols = grad_out.cols;
+        if (masked_grad.data().size() < rows * cols) {
+            masked_grad = Tensor(rows, cols);
+        }
+        float* g = masked_grad.data().data();
+        parallel_chunks(rows, std::max<size_t>(1, elementwise_grain / std::max<size_t>(cols, 1)), [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; ++r) {
+                const uint8_t* m = mask.data() + r * cols;
+                float* dst = g + r * cols;
+                if (grad_out.row_major()) {
+                    const float* src = grad_out.row(r);
+                    for (size_t c = 0; c < cols; ++c) {
+                        dst[c] = m[c] ? src[c] : 0.0f;
+                    }
+                } else {
+                    for (size_t c = 0; c < cols; ++c) {
+                        dst[c] = m[c] ? grad_out(r, c) : 0.0f;
+                    }
+                }
+            }
+        });
+        linear.backward_into(TensorView{g, grad_out.rows, grad_out.cols}, grad_in);
+    }
+}
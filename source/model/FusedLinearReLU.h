@@ -0,0 +1,52 @@
+#pragma once
+#include <model/Layer.h>
+#include <model/LinearLayer.h>
+#include <stdexcept>
+
+namespace wolf {
+
+// Linear followed by ReLU in one pass: the ReLU runs in the GEMM epilogue and
+// backward only keeps a byte mask of the positive outputs.
+// Parameters stay in (and are stepped through) the wrapped LinearLayer.
+class FusedLinearReLU : public Layer {
+public:
+    explicit FusedLinearReLU(LinearLayer& linear) : Layer(LayerKind::LinearReLU), linear(linear) {}
+
+    size_t out_cols(size_t in_cols) const override { return linear.out_cols(in_cols); }
+    void set_grad_enabled(bool on) override {
+        Layer::set_grad_enabled(on);
+        linear.set_grad_enabled(on);
+    }
+    void forward_into(const TensorView& x, TensorView out) override;
+    void infer(const TensorView& x, TensorView out, InferenceContext&) const override {
+        linear.infer_fused(x, out, Activation::ReLU);
+    }
+    void backward_into(const TensorView& grad_out, TensorView grad_in) override;
+    // The Linear's work plus the activation on its output, which touches the byte mask instead
+    LayerCost cost(runtime::Phase phase, size_t rows, size_t in_cols) const override {
+        LayerCost c = linear.cost(phase, rows, in_cols);
+        const double n = static_cast<double>(rows * linear.out_size());
+        c.flops += n;
+        c.bytes += (phase == runtime::Phase::Forward ? 1.0 : 9.0) * n;
+        return c;
+    }
+
+    bool owns_cache() const override { return linear.owns_cache(); } // The mask is always ours
+    void step_SGD(float lr, size_t batch_size) override {}
+    void step_momentum(float lr, float mu, size_t batch_size) override {}
+    void step_RMSProp(float lr, float alpha, float eps, size_t batch_size) override {}
+    void step_Adam(float lr, float beta1, float beta2, float eps, float bc1, float bc2, size_t batch_size) override {}
+    void save_body(zpp::bits::out<std::vector<std::byte>>& out) const override {
+        throw std::logic_error("FusedLinearReLU is an execution-plan layer and is never saved");
+    }
+    std::unique_ptr<Layer> replicate(ParamArena&, size_t) const override {
+        throw std::logic_error("FusedLinearReLU is an execution-plan layer and is never replicated");
+    }
+
+private:
+    LinearLayer& linear;
+    std::vector<uint8_t> mask; // [B x out_dim], 1 where the pre-activation was positive
+    Tensor masked_grad;        // grad_out with the ReLU derivative applied
+};
+
+}
@@ -0,0 +1,149 @@
+#include <model/InferenceServer.h>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+namespace wolf {
+    namespace {
+        double percentile(std::vector<float> v, double p) {
+            if (v.empty()) {
+                return 0.0;
+            }
+            const auto k = static_cast<std::size_t>(p * static_cast<double>(v.size() - 1));
+            std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+            return v[k];
+        }
+
+        float micros(std::chrono::steady_clock::duration d) {
+            return std::chrono::duration<float, std::micro>(d).count();
+        }
+    }
+
+    InferenceServer::InferenceServer(Sequential& model, std::size_t in_cols, BatchingConfig config)
+            : model(model), in_cols(in_cols), config(config),
+              inputs(std::vector<float>(std::max<std::size_t>(config.max_batch, 1) * in_cols),
+                     std::max<std::size_t>(config.max_batch, 1), in_cols),
+              batch_sizes(std::max<std::size_t>(config.max_batch, 1) + 1, 0) {
+        this->config.max_batch = std::max<std::size_t>(config.max_batch, 1);
+        queue_us.reserve(latency_window);
+        total_us.reserve(latency_window);
+        worker = std::thread([this] { run(); });
+    }
+
+    InferenceServer::~InferenceServer() {
+        {
+            std::lock_guard lock(m);
+            stop = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    std::future<std::vector<float>> InferenceServer::submit(std::span<const float> x) {
+        if (x.size() != in_cols) {
+            throw std::invalid_argument("InferenceServer::submit: expected " + std::to_string(in_cols) + " features");
+        }
+        Request r{std::vector<float>(x.begin(), x.end()), {}, Clock::now()};
+        auto result = r.result.get_future();
+        {
+            std::lock_guard lock(m);
+            if (stop) {
+                throw std::logic_error("InferenceServer::submit: server is stopping");
+            }
+            queue.push_back(std::move(r));
+        }
+        cv.notify_one();
+        return result;
+    }
+
+    void InferenceServer::run() {
+        std::vector<Request> batch;
+        batch.reserve(config.max_batch);
+        std::unique_lock lock(m);
+        for (;;) {
+            cv.wait(lock, [&] { return stop || !queue.empty(); });
+            if (queue.empty()) {
+                return; // Stopping and drained
+            }
+            // Wait for a full batch, at most until the oldest request's deadline
+            const auto deadline = queue.front().submitted + config.max_wait;
+            cv.wait_until(lock, deadline, [&] { return stop || queue.size() >= config.max_batch; });
+
+            const std::size_t n = std::min(queue.size(), config.max_batch);
+            for (std::size_t i = 0; i < n; ++i) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            lock.unlock();
+            run_batch(batch);
+            batch.clear();
+            lock.lock();
+        }
+    }
+
+    void InferenceServer::run_batch(std::vector<Request>& batch) {
+        const auto start = Clock::now();
+        const std::size_t n = batch.size();
+        float* x = inputs.data().data();
+        for (std::size_t i = 0; i < n; ++i) {
+            std::ranges::copy(batch[i].x, x + i * in_cols);
+        }
+        TensorView y;
+        std::exception_ptr error;
+        try {
+            y = model.pred_inference(TensorView{x, n, in_cols});
+        } catch (...) {
+            error = std::current_exception();
+        }
+        const auto end = Clock::now();
+
+        {
+            // Recorded before any future is ready, so a caller sees its own request counted
+            std::lock_guard lock(stats_m);
+            for (const auto& r : batch) {
+                const std::size_t slot = n_requests++ % latency_window;
+                if (queue_us.size() < latency_window) {
+                    queue_us.push_back(micros(start - r.submitted));
+                    total_us.push_back(micros(end - r.submitted));
+                } else {
+                    queue_us[slot] = micros(start - r.submitted);
+                    total_us[slot] = micros(end - r.submitted);
+                }
+            }
+            ++n_batches;
+            ++batch_sizes[n];
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            if (error) {
+                batch[i].result.set_exception(error);
+            } else {
+                const float* row = y.row(i);
+                batch[i].result.set_value(std::vector<float>(row, row + y.cols));
+            }
+        }
+    }
+
+    InferenceStats InferenceServer::stats() const {
+        std::lock_guard lock(stats_m);
+        InferenceStats s;
+        s.requests = n_requests;
+        s.batches = n_batches;
+        s.mean_batch = n_batches == 0 ? 0.0 : static_cast<double>(n_requests) / static_cast<double>(n_batches);
+        s.batch_sizes = batch_sizes;
+        s.queue_p50_us = percentile(queue_us, 0.50);
+        s.queue_p99_us = percentile(queue_us, 0.99);
+        s.total_p50_us = percentile(total_us, 0.50);
+        s.total_p99_us = percentile(total_us, 0.99);
+        return s;
+    }
+
+    void InferenceServer::reset_stats() {
+        std::lock_guard lock(stats_m);
+        n_requests = 0;
+        n_batches = 0;
+        std::ranges::fill(batch_sizes, 0);
+        queue_us.clear();
+        total_us.clear();
+    }
+}
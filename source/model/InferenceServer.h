@@ -0,0 +1,81 @@
+#pragma once
+#include <model/Sequential.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace wolf {
+
+struct BatchingConfig {
+    std::size_t max_batch = 32;              // Rows per pred call
+    std::chrono::microseconds max_wait{1000}; // Longest the oldest queued request waits for company
+};
+
+struct InferenceStats {
+    std::uint64_t requests = 0;
+    std::uint64_t batches = 0;
+    double mean_batch = 0.0;
+    std::vector<std::uint64_t> batch_sizes; // batch_sizes[n]: batches of n rows
+    // Over the most recent requests, in microseconds
+    double queue_p50_us = 0.0; // Submit to start of its batch
+    double queue_p99_us = 0.0;
+    double total_p50_us = 0.0; // Submit to result
+    double total_p99_us = 0.0;
+};
+
+// Serves single-sample requests from any number of threads with batched pred calls.
+// A worker thread collects requests until max_batch are queued or the oldest has
+// waited max_wait, runs them as one batch and fulfils each future with its output row.
+// The model belongs to the server while it runs and must not be used elsewhere.
+class InferenceServer {
+public:
+    InferenceServer(Sequential& model, std::size_t in_cols, BatchingConfig config = {});
+    ~InferenceServer(); // Answers everything already submitted, then stops
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // x must hold in_cols features; it is copied before submit returns.
+    std::future<std::vector<float>> submit(std::span<const float> x);
+
+    InferenceStats stats() const;
+    void reset_stats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Request {
+        std::vector<float> x;
+        std::promise<std::vector<float>> result;
+        Clock::time_point submitted;
+    };
+
+    void run();
+    void run_batch(std::vector<Request>& batch);
+
+    Sequential& model;
+    std::size_t in_cols;
+    BatchingConfig config;
+    Tensor inputs; // [max_batch x in_cols]
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<Request> queue;
+    bool stop = false;
+
+    static constexpr std::size_t latency_window = 1 << 14; // Requests kept for the percentiles
+    mutable std::mutex stats_m;
+    std::uint64_t n_requests = 0;
+    std::uint64_t n_batches = 0;
+    std::vector<std::uint64_t> batch_sizes;
+    std::vector<float> queue_us; // Rings of latency_window samples
+    std::vector<float> total_us;
+
+    std::thread worker; // Last: starts once everything above exists
+};
+
+}
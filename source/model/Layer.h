@@ -1,5 +1,12 @@
 #pragma once
 #include <math/tensor.h>
+#include <math/sparse.h>
+#include <model/ParamArena.h>
+#include <math/aligned.h>
+#include <runtime/Profiler.h>
+#include <array>
+#include <span>
+#include <stdexcept>
 #include <vector>
 #include <memory>
 #include <external/zpp_bits.h>
@@ -9,23 +16,142 @@ namespace wolf {
 enum class LayerKind : uint8_t {
     Linear,
     ReLU,
+    LinearReLU, // Built by Sequential's fusion pass, never serialized
+    QuantizedLinear,
+    SparseLinear,
+    Embedding,
 };
+// Storage precision of weights and cached activations. Master weights,
+// optimizer state and GEMM accumulation are fp32 either way.
+enum class Precision : uint8_t {
+    FP32,
+    BF16,
+};
+
+// Scratch memory of one thread for the const inference path (Sequential::pred(x, ctx)).
+// Keep one per thread and reuse it: buffers only grow, so steady state allocates nothing.
+class InferenceContext {
+public:
+    // At least n bytes, tensor_alignment aligned, valid until the next call.
+    std::byte* scratch(size_t n) {
+        const size_t floats = (n + sizeof(float) - 1) / sizeof(float);
+        if (scratch_buf.size() < floats) {
+            scratch_buf = AlignedBuffer(floats);
+        }
+        return reinterpret_cast<std::byte*>(scratch_buf.data());
+    }
+
+private:
+    friend class Sequential;
+    std::array<AlignedBuffer, 2> acts; // Ping-pong layer outputs
+    AlignedBuffer scratch_buf;
+};
+
+// Work of one pass, as counted by the profiler.
+struct LayerCost {
+    double flops = 0;
+    double bytes = 0;
+};
+
+// Parameter rows with a non-zero gradient, for a row-sparse optimizer update: rows index
+// row_floats-float rows from the layer's first parameter, and [dense_from, param_count())
+// is always updated. row_floats == 0 means every parameter may have a gradient.
+struct SparseRows {
+    std::span<const uint32_t> rows;
+    size_t row_floats = 0;
+    size_t dense_from = 0;
+};
+
 class Layer {
 public:
-    virtual Tensor forward(const Tensor& x) = 0;
-    virtual Tensor backward(const Tensor& grad_out) = 0; // input: gradient of the output, output: gradient of the input 
+    // Number of output columns for an input with in_cols columns.
+    virtual size_t out_cols(size_t in_cols) const = 0;
+
+    // out must already be [x.rows x out_cols(x.cols)]. The layer keeps a view of x,
+    // so x must stay valid and unchanged until the matching backward_into. Inputs may be
+    // any TensorView (strided, sliced, transposed); out and grad_in must be row-major.
+    virtual void forward_into(const TensorView& x, TensorView out) = 0;
+    // forward_into for inference that leaves the layer untouched, so any number of threads
+    // may call it at once; temporary memory comes from ctx.
+    virtual void infer(const TensorView& x, TensorView out, InferenceContext& ctx) const = 0;
+    // grad_in must already be [grad_out.rows x cols of the last forward input].
+    virtual void backward_into(const TensorView& grad_out, TensorView grad_in) = 0;
+    // Sparse or index input, for a first layer. x must stay valid until the matching
+    // backward_sparse, which only accumulates parameter gradients: the input is data and needs none.
+    virtual void forward_sparse(const SparseView& x, TensorView out) {
+        throw std::logic_error("Layer does not accept sparse input");
+    }
+    virtual void forward_indices(const IndexView& x, TensorView out) {
+        throw std::logic_error("Layer does not accept index input");
+    }
+    virtual void backward_sparse(const TensorView& grad_out) {
+        throw std::logic_error("Layer does not accept sparse input");
+    }
+    // Rows touched by backward_sparse since the last params_changed(); see SparseRows.
+    virtual SparseRows touched_rows() const { return {}; }
+
+    // Allocating wrappers around forward_into / backward_into.
+    Tensor forward(const Tensor& x);
+    Tensor backward(const Tensor& grad_out); // input: gradient of the output, output: gradient of the input 
     
     virtual void step_SGD(float lr, size_t batch_size) = 0;
     virtual void step_momentum(float lr, float mu, size_t batch_size) = 0;
     virtual void step_RMSProp(float lr, float alpha, float eps, size_t batch_size) = 0;
     virtual void step_Adam(float lr, float beta1, float beta2, float eps, float bc1, float bc2, size_t batch_size) = 0;
     virtual ~Layer() = default;
+
+    // Floats this layer needs in each ParamArena region (0 without parameters).
+    virtual size_t param_count() const { return 0; }
+    // Moves parameters and optimizer state to arena[offset, offset + param_count()) and views them there.
+    virtual void bind_params(ParamArena& arena, size_t offset) {}
+    // A new layer of the same shape whose parameters are the ones already at
+    // arena[offset, offset + param_count()); nothing is copied.
+    virtual std::unique_ptr<Layer> replicate(ParamArena& arena, size_t offset) const = 0;
+
     LayerKind kind() const noexcept { return _kind; }
     virtual void save_body(zpp::bits::out<std::vector<std::byte>>& out) const = 0;
+    // Model files store arena parameters in their own aligned section; save_shape writes the rest.
+    virtual void save_shape(zpp::bits::out<std::vector<std::byte>>& out) const { save_body(out); }
+    // First of this layer's param_count() contiguous parameters, null without any.
+    virtual const float* param_data() const { return nullptr; }
+
+    virtual void set_precision(Precision) {}
+    // True when forward_into copies what backward needs, so x may be overwritten right after.
+    virtual bool owns_cache() const { return false; }
+    // Called after the optimizer changed the parameters in place.
+    virtual void params_changed() {}
+    // Forward or Backward over rows inputs of in_cols columns (0 where unknown).
+    virtual LayerCost cost(runtime::Phase, size_t rows, size_t in_cols) const { return {}; }
+    virtual LayerCost sparse_cost(runtime::Phase, size_t rows, size_t nnz) const { return {}; }
+
+    // With gradients disabled the layer keeps nothing for backward (inference).
+    virtual void set_grad_enabled(bool on) { grad_enabled = on; }
+    bool is_grad_enabled() const { return grad_enabled; }
 protected:
     explicit Layer(LayerKind k) : _kind(k) {}
+    bool grad_enabled = true;
 private:
     LayerKind _kind;
+    Tensor input_cache; // Owns the input of forward() until backward()
 };
 
+inline Tensor Layer::forward(const Tensor& x) {
+    const size_t cols = out_cols(x.ncols());
+    Tensor out(x.nrows(), cols);
+    if (!grad_enabled) {
+        forward_into(TensorView{const_cast<float*>(x.data().data()), x.nrows(), x.ncols(), x.ld()}, TensorView{out});
+        return out;
+    }
+    input_cache = x;
+    forward_into(TensorView{input_cache}, TensorView{out});
+    return out;
+}
+
+inline Tensor Layer::backward(const Tensor& grad_out) {
+    Tensor grad_in(grad_out.nrows(), input_cache.ncols());
+    TensorView g{const_cast<float*>(grad_out.data().data()), grad_out.nrows(), grad_out.ncols(), grad_out.ld()};
+    backward_into(g, TensorView{grad_in});
+    return grad_in;
+}
+
 }
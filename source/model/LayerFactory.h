@@ -3,11 +3,21 @@
 #include <model/Layer.h>
 #include <model/LinearLayer.h>
 #include <model/ReLU.h>
+#include <model/SparseLinearLayer.h>
+#include <model/Embedding.h>
 
 namespace wolf {
     inline std::unique_ptr<Layer> Linear(size_t in_dim, size_t out_dim) {
         return std::make_unique<LinearLayer>(in_dim, out_dim);
     }
+    // First layer for wide sparse inputs, see Sequential::pred(const SparseView&)
+    inline std::unique_ptr<Layer> SparseLinear(size_t in_dim, size_t out_dim) {
+        return std::make_unique<SparseLinearLayer>(in_dim, out_dim);
+    }
+    // First layer for categorical ids, see Sequential::pred(const IndexView&)
+    inline std::unique_ptr<Layer> Embedding(size_t vocab, size_t dim) {
+        return std::make_unique<EmbeddingLayer>(vocab, dim);
+    }
     inline std::unique_ptr<Layer> ReLU() {
         return std::make_unique<ReLULayer>();
     }
@@ -7,6 +7,9 @@
 #include <model/Layer.h>
 #include <model/LinearLayer.h>
 #include <model/ReLU.h>
+#include <model/QuantizedLinear.h>
+#include <model/SparseLinearLayer.h>
+#include <model/Embedding.h>
 #include <external/zpp_bits.h>
 
 namespace wolf {
@@ -28,8 +31,33 @@ namespace wolf {
             return LinearLayer::load_from(in);
         case LayerKind::ReLU:
             return ReLULayer::load_from(in);
+        case LayerKind::QuantizedLinear:
+            return QuantizedLinear::load_from(in);
+        case LayerKind::SparseLinear:
+            return SparseLinearLayer::load_from(in);
+        case LayerKind::Embedding:
+            return EmbeddingLayer::load_from(in);
         default:
             throw std::runtime_error("load_layer: unknown LayerKind");
         }
     }
-}
\ No newline at end of file
+
+    // Read one Layer of a model file: parameters are already at arena[offset, ...).
+    inline std::unique_ptr<Layer> load_layer(LayerKind kind, zpp::bits::in<std::vector<std::byte>>& in,
+                                             ParamArena& arena, size_t offset) {
+        switch (kind) {
+        case LayerKind::Linear:
+            return LinearLayer::load_view(in, arena, offset);
+        case LayerKind::ReLU:
+            return ReLULayer::load_from(in);
+        case LayerKind::QuantizedLinear:
+            return QuantizedLinear::load_from(in);
+        case LayerKind::SparseLinear:
+            return SparseLinearLayer::load_view(in, arena, offset);
+        case LayerKind::Embedding:
+            return EmbeddingLayer::load_view(in, arena, offset);
+        default:
+            throw std::runtime_error("load_layer: unknown LayerKind");
+        }
+    }
+}
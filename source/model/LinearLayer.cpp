@@ -1,144 +1,152 @@
 #include <model/LinearLayer.h>
 #include <math/rng.h>
+#include <math/gemm.h>
+#include <math/parallel.h>
+#include <math/simd/simd.h>
 #include <algorithm>
 #include <utils/timer.h>
 namespace wolf {
-    LinearLayer::LinearLayer(size_t x_dim, size_t y_dim) : Layer(LayerKind::Linear), x_dim(x_dim),
+    LinearLayer::LinearLayer(size_t x_dim, size_t y_dim) : ArenaLayer(LayerKind::Linear), x_dim(x_dim),
             y_dim(y_dim) {
+        own_slot();
+
         auto& gen = rng().gen;
         auto normal_gen = [&]() {return std::normal_distribution<float>{0.0f, std::sqrt(2.0f / x_dim)}(gen);};
-        std::vector<float> temp(y_dim * x_dim);
-        std::vector<float> temp_b(y_dim);
-        std::ranges::generate(temp, normal_gen);
-        std::ranges::generate(temp_b, normal_gen);
-        W = Tensor(std::move(temp), y_dim, x_dim);
-        dW = Tensor(std::vector<float>(y_dim * x_dim, 0.0f), y_dim, x_dim);
-        vW = Tensor(std::vector<float>(y_dim * x_dim, 0.0f), y_dim, x_dim);
-        b = Tensor(std::move(temp_b), 1, y_dim);
-        vb = Tensor(std::vector<float>(y_dim, 0.0f), 1, y_dim);
-        db = Tensor(std::vector<float>(y_dim, 0.0f), 1, y_dim);
-        rW = Tensor(std::vector<float>(y_dim * x_dim, 0.0f), y_dim, x_dim);
-        rb = Tensor(std::vector<float>(y_dim, 0.0f), 1, y_dim);
-    }
-    Tensor LinearLayer::forward(const Tensor& x) {
-        last_input = x;
-        size_t batch_size = x.nrows();
-        std::vector<float> out(batch_size * y_dim);
-        #pragma omp parallel for 
-        for (std::ptrdiff_t j_ = 0; j_ < y_dim * batch_size; j_++) {
-            size_t j = static_cast<size_t>(j_);
-            const size_t k  = j % y_dim;      // output neuron index
-            const size_t bn = j / y_dim;      // batch index
-            float sum = b(k);
-            for (size_t i = 0; i < x_dim; ++i) {
-                sum += x(i + x_dim * bn) * W(k, i);
-            }
-            out[j] = sum;
-        }
-        return Tensor(out, batch_size, y_dim);
+        std::generate_n(W.data, W.size(), normal_gen);
+        std::generate_n(b.data, b.size(), normal_gen);
     }
 
-    Tensor LinearLayer::backward(const Tensor& grad_out) {
-        size_t batch_size = grad_out.nrows();
-        std::vector<float> grad_in(x_dim * batch_size, 0.0f);
-
-        // Unparallelized version of the below code:
-        // for (size_t i = 0; i < y_dim; i++) {
-        //     db(i) = grad_in(i) / (float)batch_size;
-        //     for (size_t j = 0; j < x_dim; j++) {
-        //         dW[i * x_dim + j] = grad_in(i) * x[j] / (float)batch_size;
-        //         grad_in[j] += W[i * x_dim + j] * grad_out(i); 
-        //     }
-        // }
+    LinearLayer::LinearLayer(size_t x_dim, size_t y_dim, ParamArena& arena, size_t offset)
+            : ArenaLayer(LayerKind::Linear), x_dim(x_dim), y_dim(y_dim) {
+        view_params(arena, offset);
+    }
 
-        #pragma omp parallel for 
-        for (std::ptrdiff_t i_ = 0; i_ < y_dim; i_++) {
-            size_t y = static_cast<size_t>(i_);
-            float db_acc = 0.0f;
-            const size_t y_flatten = y * x_dim;
+    void LinearLayer::view_params(ParamArena& target, size_t offset) {
+        arena = &target;
+        arena_offset = offset;
+        const size_t b_offset = offset + align_floats(y_dim * x_dim);
+        W  = target.view(ParamArena::Params,  offset, y_dim, x_dim);
+        dW = target.view(ParamArena::Grads,   offset, y_dim, x_dim);
+        b  = target.view(ParamArena::Params,  b_offset, 1, y_dim);
+        db = target.view(ParamArena::Grads,   b_offset, 1, y_dim);
+    }
 
-            for (size_t sample_idx = 0; sample_idx < batch_size; ++sample_idx) {
-                const float this_sample_grad_out = grad_out(sample_idx * y_dim + y);
-                db_acc += this_sample_grad_out;
-                const size_t sample_in_offset = sample_idx * x_dim;
-                for (size_t x = 0; x < x_dim; ++x) {
-                        dW(y_flatten + x) += this_sample_grad_out * last_input(x + sample_in_offset);
-                }
-            }
+    void LinearLayer::forward_into(const TensorView& x, TensorView out) {
+        forward_fused(x, out, Activation::None, nullptr);
+    }
 
-            db(y) = db_acc;
+    void LinearLayer::set_precision(Precision p) {
+        precision = p;
+        w16_stale = true;
+        if (p == Precision::FP32) {
+            W16 = {};
+            x16 = {};
         }
-        #pragma omp parallel for 
-        for (std::ptrdiff_t j_ = 0; j_ < x_dim; j_++) {
-            size_t x = static_cast<size_t>(j_);
-            for (size_t sample_idx = 0; sample_idx < batch_size; ++sample_idx) {    
-                float sum = 0.0f;
-                const size_t sample_out_offset = sample_idx * y_dim;
-                for (size_t y = 0; y < y_dim; ++y) {
-                    sum += W(y * x_dim + x) * grad_out(y + sample_out_offset);
-                }
-                grad_in[sample_idx * x_dim + x] = sum;  
-            }
-        };
-        return Tensor(grad_in, batch_size, x_dim);
-
     }
 
-    void LinearLayer::step_SGD(float lr, size_t batch_size) {
-        const float scale = lr / static_cast<float>(batch_size);
-        #pragma omp parallel for 
-        for (std::ptrdiff_t i_ = 0; i_ < W.size(); i_++) {
-            size_t W_idx = static_cast<size_t>(i_);
-            W(W_idx) -= scale * dW(W_idx) ;
-            dW(W_idx) = 0.0f;
+    LayerCost LinearLayer::cost(runtime::Phase phase, size_t rows, size_t) const {
+        const double r = static_cast<double>(rows);
+        const double xy = static_cast<double>(x_dim * y_dim);
+        const double wb = precision == Precision::BF16 ? 2.0 : 4.0; // Bytes per weight and cached input
+        if (phase == runtime::Phase::Forward) {
+            return {2.0 * r * xy + r * y_dim, wb * xy + 4.0 * (y_dim + r * (x_dim + y_dim))};
         }
+        // dW, grad_in and db; dW and db are read and written
+        return {4.0 * r * xy + r * y_dim, (wb + 8.0) * xy + 8.0 * y_dim + r * (wb * x_dim + 4.0 * (x_dim + y_dim))};
+    }
 
-        #pragma omp parallel for 
-        for (std::ptrdiff_t i_ = 0; i_ < b.size(); i_++) {
-            size_t b_idx = static_cast<size_t>(i_);
-            b(b_idx) -= scale * db(b_idx);
-            db(b_idx) = 0.0f;
+    void LinearLayer::forward_fused(const TensorView& x, TensorView out, Activation act, uint8_t* mask) {
+        size_t batch_size = x.rows;
+        const GemmOperand xa = gemm_operand(x);
+        const GemmEpilogue ep{.bias = b.data, .act = act, .mask = mask, .ldm = y_dim};
+        if (precision == Precision::BF16) {
+            const auto& k = simd::kernels();
+            if (w16_stale) {
+                W16.resize(W.size());
+                parallel_chunks(W.size(), elementwise_grain, [&](size_t i0, size_t i1) {
+                    k.to_bf16(W.data + i0, W16.data() + i0, i1 - i0);
+                });
+                w16_stale = false;
+            }
+            last_input = TensorView{};
+            if (grad_enabled) {
+                if (x16.size() < x.size()) {
+                    x16.resize(x.size());
+                }
+                if (x.contiguous()) {
+                    parallel_chunks(x.size(), elementwise_grain, [&](size_t i0, size_t i1) {
+                        k.to_bf16(x.data + i0, x16.data() + i0, i1 - i0);
+                    });
+                } else {
+                    const TensorView xr = row_major(x, x_rows);
+                    parallel_chunks(x.rows, std::max<size_t>(1, elementwise_grain / x_dim), [&](size_t r0, size_t r1) {
+                        for (size_t r = r0; r < r1; ++r) {
+                            k.to_bf16(xr.row(r), x16.data() + r * x_dim, x_dim);
+                        }
+                    });
+                }
+            }
+            gemm(xa.trans, Trans::Yes, batch_size, y_dim, x_dim,
+                 xa.data, xa.ld,
+                 W16.data(), x_dim,
+                 0.0f, out.data, out.stride, ep);
+            return;
         }
-
+        last_input = grad_enabled ? x : TensorView{};
+        // out = act(x * W^T + b)
+        gemm(xa.trans, Trans::Yes, batch_size, y_dim, x_dim,
+             xa.data, xa.ld,
+             W.data, x_dim,
+             0.0f, out.data, out.stride, ep);
     }
 
-    void LinearLayer::step_momentum(float lr, float mu, size_t batch_size) {
-        const float scale = lr / static_cast<float>(batch_size);
-        #pragma omp parallel for 
-        for (std::ptrdiff_t i_ = 0; i_ < W.size(); i_++) {
-            size_t W_idx = static_cast<size_t>(i_);
-            vW(W_idx) = -scale * dW(W_idx) + mu * vW(W_idx);
-            W(W_idx) += vW(W_idx);
-            dW(W_idx) = 0.0f;
+    void LinearLayer::infer_fused(const TensorView& x, TensorView out, Activation act) const {
+        const GemmEpilogue ep{.bias = b.data, .act = act};
+        const GemmOperand xa = gemm_operand(x);
+        if (precision == Precision::BF16 && !w16_stale) {
+            gemm(xa.trans, Trans::Yes, x.rows, y_dim, x_dim, xa.data, xa.ld, W16.data(), x_dim, 0.0f, out.data, out.stride, ep);
+        } else {
+            gemm(xa.trans, Trans::Yes, x.rows, y_dim, x_dim, xa.data, xa.ld, W.data, x_dim, 0.0f, out.data, out.stride, ep);
         }
+    }
+
+    void LinearLayer::backward_into(const TensorView& grad_out, TensorView grad_in) {
+        size_t batch_size = grad_out.rows;
 
-        #pragma omp parallel for 
-        for (std::ptrdiff_t i_ = 0; i_ < b.size(); i_++) {
-            size_t b_idx = static_cast<size_t>(i_);
-            vb(b_idx) = -scale * db(b_idx) + mu * vb(b_idx);
-            b(b_idx) += vb(b_idx);
-            db(b_idx) = 0.0f;
+        // dW += grad_out^T * x
+        const GemmOperand gt = gemm_operand(grad_out, Trans::Yes);
+        if (precision == Precision::BF16) {
+            gemm(gt.trans, Trans::No, y_dim, x_dim, batch_size,
+                 gt.data, gt.ld,
+                 x16.data(), x_dim,
+                 1.0f, dW.data, x_dim);
+        } else {
+            const GemmOperand xa = gemm_operand(last_input);
+            gemm(gt.trans, xa.trans, y_dim, x_dim, batch_size,
+                 gt.data, gt.ld,
+                 xa.data, xa.ld,
+                 1.0f, dW.data, x_dim);
         }
-    }
 
-    void LinearLayer::step_RMSProp(float lr, float alpha, float eps, size_t batch_size) {
-        const float scale = lr / static_cast<float>(batch_size);
-        #pragma omp parallel for 
-        for (std::ptrdiff_t i_ = 0; i_ < W.size(); i_++) {
-            size_t W_idx = static_cast<size_t>(i_);
-            rW(W_idx) = alpha * rW(W_idx) +  (1.0f - alpha) * dW(W_idx) * dW(W_idx);
-            W(W_idx) -= scale * dW(W_idx) / (std::sqrt(rW(W_idx)) + eps);
-            dW(W_idx) = 0.0f;
+        // db += column sums of grad_out
+        for (size_t sample_idx = 0; sample_idx < batch_size; ++sample_idx) {
+            for (size_t y = 0; y < y_dim; ++y) {
+                db(y) += grad_out(sample_idx, y);
+            }
         }
 
-        #pragma omp parallel for 
-        for (std::ptrdiff_t i_ = 0; i_ < b.size(); i_++) {
-            size_t b_idx = static_cast<size_t>(i_);
-            rb(b_idx) = alpha * rb(b_idx) + (1.0f - alpha) * db(b_idx) * db(b_idx);
-            b(b_idx) -= scale * db(b_idx) / (std::sqrt(rb(b_idx)) + eps);
-            db(b_idx) = 0.0f;
+        // grad_in = grad_out * W, with the same weights forward used
+        const GemmOperand g = gemm_operand(grad_out);
+        if (precision == Precision::BF16) {
+            gemm(g.trans, Trans::No, batch_size, x_dim, y_dim,
+                 g.data, g.ld,
+                 W16.data(), x_dim,
+                 0.0f, grad_in.data, grad_in.stride);
+        } else {
+            gemm(g.trans, Trans::No, batch_size, x_dim, y_dim,
+                 g.data, g.ld,
+                 W.data, x_dim,
+                 0.0f, grad_in.data, grad_in.stride);
         }
     }
-
-    // Step Adam in AdamStepper.cpp due to floating math restrictions
 }
\ No newline at end of file
@@ -1,55 +1,90 @@
 #pragma once
 #include <math/tensor.h>
-#include <model/Layer.h>
+#include <math/gemm.h>
+#include <model/ArenaLayer.h>
 #include <external/zpp_bits.h>
+#include <algorithm>
+#include <span>
+#include <stdexcept>
 
 namespace wolf {
 
 // Symbol meanings:
 // y = Wx + b
 
-class LinearLayer : public Layer {
+class LinearLayer : public ArenaLayer {
 public:
     LinearLayer(size_t x_dim, size_t y_dim);
+    LinearLayer(size_t x_dim, size_t y_dim, ParamArena& arena, size_t offset);
 
-    Tensor forward(const Tensor& x) override;
-    Tensor backward(const Tensor& grad_out) override;
-    void step_SGD(float lr, size_t batch_size) override;
-    void step_momentum(float lr, float mu, size_t batch_size) override;
-    void step_RMSProp(float lr, float alpha, float eps, size_t batch_size) override;
-    void step_Adam(float lr, float beta1, float beta2, float eps, float bc1, float bc2, size_t batch_size) override;
+    size_t out_cols(size_t) const override { return y_dim; }
+    void forward_into(const TensorView& x, TensorView out) override;
+    void backward_into(const TensorView& grad_out, TensorView grad_in) override;
+    // forward_into with an activation applied in the GEMM epilogue; mask ([B x out_dim]) may be null.
+    void forward_fused(const TensorView& x, TensorView out, Activation act, uint8_t* mask);
+    void infer(const TensorView& x, TensorView out, InferenceContext&) const override {
+        infer_fused(x, out, Activation::None);
+    }
+    // Const forward_fused without mask. BF16 uses the bfloat16 weights only while they are
+    // current (they are refreshed by the next non-const forward); otherwise the fp32 master.
+    void infer_fused(const TensorView& x, TensorView out, Activation act) const;
+    // BF16 keeps a bfloat16 copy of W for the GEMMs and caches the input as bfloat16.
+    void set_precision(Precision p) override;
+    bool owns_cache() const override { return precision == Precision::BF16; }
+    void params_changed() override { w16_stale = true; }
+    LayerCost cost(runtime::Phase phase, size_t rows, size_t in_cols) const override;
     size_t in_size() const {return x_dim;}
     size_t out_size() const {return y_dim;}
-    Tensor weights() const {return W;}
-    Tensor bias() const {return b;}
+    Tensor weights() const {return Tensor(std::vector<float>(W.data, W.data + W.size()), y_dim, x_dim);}
+    Tensor bias() const {return Tensor(std::vector<float>(b.data, b.data + b.size()), 1, y_dim);}
+    size_t param_count() const override { return align_floats(y_dim * x_dim) + align_floats(y_dim); }
+    std::unique_ptr<Layer> replicate(ParamArena& arena, size_t offset) const override {
+        return std::make_unique<LinearLayer>(x_dim, y_dim, arena, offset);
+    }
     void save_body(zpp::bits::out<std::vector<std::byte>>& out) const override {
-        const auto& Wv = W.data();
-        const auto& bv = b.data();
+        const std::span<const float> Wv(W.data, W.size());
+        const std::span<const float> bv(b.data, b.size());
         out(x_dim, y_dim, Wv, bv).or_throw();
     }
+    void save_shape(zpp::bits::out<std::vector<std::byte>>& out) const override {
+        out(x_dim, y_dim).or_throw();
+    }
+    const float* param_data() const override { return W.data; } // b follows W in the slot
+    // Counterpart of save_shape: a layer viewing parameters already at arena[offset, ...).
+    static std::unique_ptr<Layer> load_view(zpp::bits::in<std::vector<std::byte>>& in, ParamArena& arena, size_t offset) {
+        std::size_t x_dim{}, y_dim{};
+        in(x_dim, y_dim).or_throw();
+        return std::make_unique<LinearLayer>(x_dim, y_dim, arena, offset);
+    }
     static std::unique_ptr<Layer> load_from(zpp::bits::in<std::vector<std::byte>>& in) {
         std::size_t x_dim{}, y_dim{};
         std::vector<float> Wv, bv;
         in(x_dim, y_dim, Wv, bv).or_throw();
+        if (Wv.size() != x_dim * y_dim || bv.size() != y_dim) {
+            throw std::runtime_error("LinearLayer::load_from: weight size mismatch");
+        }
 
         auto layer = std::make_unique<LinearLayer>(x_dim, y_dim);
-        layer->W.data() = std::move(Wv);
-        layer->b.data() = std::move(bv);
+        std::ranges::copy(Wv, layer->W.data);
+        std::ranges::copy(bv, layer->b.data);
         return layer;
     }
 private:
+    void view_params(ParamArena& target, size_t offset) override;
+
     size_t x_dim;
     size_t y_dim;
-    Tensor W;   // [out_dim x in_dim]
-    Tensor dW;
-    Tensor b;   // [out_dim x 1]
-    Tensor db;
-    Tensor last_input; // [B x in_dim]
-    Tensor vW; // Momentum term
-    Tensor vb;
-    Tensor rW; // RMSProp term
-    Tensor rb;
-    float mu;
+    // Views into arena
+    TensorView W;   // [out_dim x in_dim]
+    TensorView dW;
+    TensorView b;   // [out_dim x 1]
+    TensorView db;
+    TensorView last_input; // [B x in_dim], owned by the caller
+    Precision precision = Precision::FP32;
+    std::vector<bf16> W16; // BF16: rounded copy of W, rebuilt after each update
+    std::vector<bf16> x16; // BF16: the cached input
+    AlignedVector x_rows;  // BF16: a column-major input gathered into rows
+    bool w16_stale = true;
 };
 
 } // namespace nn
@@ -0,0 +1,74 @@
+#include <model/Loss.h>
+#include <math/parallel.h>
+#include <algorithm>
+
+namespace wolf {
+    namespace {
+        size_t rows_per_chunk(size_t cols) {
+            return std::max<size_t>(1, elementwise_grain / std::max<size_t>(1, cols));
+        }
+
+        // Loss of rows [r0, r1), gradient written to the same rows of grad. Row-major views.
+        float loss_and_grad_rows(LossType l, const TensorView& a, const TensorView& b, const TensorView& grad,
+                                 size_t r0, size_t r1) {
+            const auto& k = simd::kernels();
+            const size_t cols = a.cols;
+            // Element-wise losses: one kernel call over the whole range when nothing is strided
+            auto elementwise = [&](auto kernel) {
+                if (a.contiguous() && b.contiguous() && grad.contiguous()) {
+                    const size_t begin = r0 * cols;
+                    return kernel(a.data + begin, b.data + begin, grad.data + begin, (r1 - r0) * cols);
+                }
+                float out = 0.0f;
+                for (size_t i = r0; i < r1; ++i) {
+                    out += kernel(a.row(i), b.row(i), grad.row(i), cols);
+                }
+                return out;
+            };
+            switch (l) {
+                case LossType::MSE:
+                    return elementwise(k.sub_half_sq_sum);
+                case LossType::CrossEntropy: {
+                    float out = 0.0f;
+                    for (size_t i = r0; i < r1; ++i) {
+                        const float* z = a.row(i);
+                        const float* t = b.row(i);
+                        float* g = grad.row(i);
+                        const float m = k.max(z, cols);
+                        const float sum = k.exp_shift_sum(z, m, g, cols);
+                        const float logsumexp = m + std::log(sum + 1e-30f);
+                        out += logsumexp * k.sum(t, cols) - k.dot(t, z, cols);
+                        // softmax - target
+                        k.scale_sub(g, 1.0f / sum, t, g, cols);
+                    }
+                    return out;
+                }
+                case LossType::BCEWithLogits:
+                    return elementwise(k.bce_with_logits_grad);
+            }
+            return 0.0f;
+        }
+    }
+
+    size_t loss_chunks(size_t rows, size_t cols) {
+        return (rows + rows_per_chunk(cols) - 1) / rows_per_chunk(cols);
+    }
+
+    float loss_and_grad(LossType l, const TensorView& a, const TensorView& b, TensorView grad, float* partial) {
+        AlignedVector a_rows, b_rows; // Only used for column-major a or b
+        const TensorView ar = row_major(a, a_rows);
+        const TensorView br = row_major(b, b_rows);
+        const size_t chunk = rows_per_chunk(a.cols);
+        // Summed in chunk order afterwards, so the loss does not depend on scheduling
+        runtime::parallel_for(a.rows, chunk, [&](size_t r0, size_t r1) {
+            for (size_t c0 = r0; c0 < r1; c0 += chunk) {
+                partial[c0 / chunk] = loss_and_grad_rows(l, ar, br, grad, c0, std::min(r1, c0 + chunk));
+            }
+        });
+        float total = 0.0f;
+        for (size_t c = 0; c < loss_chunks(a.rows, a.cols); ++c) {
+            total += partial[c];
+        }
+        return total;
+    }
+}
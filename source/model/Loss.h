@@ -1,6 +1,8 @@
 #pragma once
 #include <cstdint>
 #include <cmath>
+#include <math/tensor.h>
+#include <math/simd/simd.h>
 
 namespace wolf {
 
@@ -14,60 +16,52 @@ namespace wolf {
         LossType l = LossType::MSE;
     };
 
-    inline float mse_loss(const TensorView& a, const TensorView& b) {
-        const auto& a_raw = a.data;
-        const auto& b_raw = b.data;
+    // Sum of fn(a row, b row, cols) over the rows, in one call when both are contiguous.
+    // Row-major views.
+    template <class F>
+    float sum_rows(const TensorView& a, const TensorView& b, F&& fn) {
+        if (a.contiguous() && b.contiguous()) {
+            return fn(a.data, b.data, a.rows * a.cols);
+        }
         float out = 0.0f;
-        for (size_t i = 0; i < a.cols * a.rows; i++) {
-            out += 0.5 * (a_raw[i] - b_raw[i]) * (a_raw[i] - b_raw[i]);
+        for (size_t i = 0; i < a.rows; ++i) {
+            out += fn(a.row(i), b.row(i), a.cols);
         }
         return out;
     }
 
-    inline float cross_entropy_loss(const TensorView& a, const TensorView& b) {
-        const size_t a_rows = a.rows, a_cols = a.cols;
-        const auto* a_ = a.data;
-        const auto* b_ = b.data;
-
-        float out = 0.0f;
-        for (size_t i = 0; i < a_rows; ++i) {
-            const size_t row = i * a_cols;
-
-            float m = a_[row];
-            for (size_t j = 1; j < a_cols; ++j)
-                m = std::max(m, a_[row + j]);
-
-            float sumexp = 0.0f;
-            for (size_t j = 0; j < a_cols; ++j)
-                sumexp += std::exp(a_[row + j] - m);
-
-            const float logsumexp = m + std::log(sumexp + 1e-30f);
+    inline float mse_loss(const TensorView& a, const TensorView& b) {
+        AlignedVector a_rows, b_rows;
+        return sum_rows(row_major(a, a_rows), row_major(b, b_rows), simd::kernels().half_sq_diff_sum);
+    }
 
-            float row_loss = 0.0f;
-            for (size_t j = 0; j < a_cols; ++j) {
-                const float bj = b_[row + j];
-                if (bj != 0.0f) {
-                    row_loss += bj * (logsumexp - a_[row + j]);
-                }
+    inline float cross_entropy_loss(const TensorView& a, const TensorView& b) {
+        AlignedVector a_rows, b_rows;
+        const auto& k = simd::kernels();
+        return sum_rows(row_major(a, a_rows), row_major(b, b_rows), [&](const float* z, const float* t, size_t n) {
+            float out = 0.0f;
+            for (size_t i = 0; i < n; i += a.cols) {
+                const float m = k.max(z + i, a.cols);
+                const float sumexp = k.exp_shift_sum(z + i, m, nullptr, a.cols);
+                const float logsumexp = m + std::log(sumexp + 1e-30f);
+                // sum_j b_j * (logsumexp - a_j)
+                out += logsumexp * k.sum(t + i, a.cols) - k.dot(t + i, z + i, a.cols);
             }
-            out += row_loss;
-        }
-        return out;
+            return out;
+        });
     }
 
     inline float bce_with_logits_loss(const TensorView& a, const TensorView& b) {
-        const auto* a_ = a.data;
-        const auto* b_ = b.data;
-        const size_t n = a.rows * a.cols;
-
-        float out = 0.0f;
-        for (size_t i = 0; i < n; ++i) {
-            const float ai = a_[i];
-            const float bi = b_[i];
-            const float absz = std::abs(ai);
-            out += std::max(ai, 0.0f) - ai * bi + std::log1p(std::exp(-absz));
-        }
-        return out;
+        AlignedVector a_rows, b_rows;
+        return sum_rows(row_major(a, a_rows), row_major(b, b_rows), simd::kernels().bce_with_logits_sum);
     }
+
+    // Chunks loss_and_grad splits rows x cols logits into: the floats its partial sums need.
+    size_t loss_chunks(size_t rows, size_t cols);
+
+    // Loss summed over the batch and its gradient w.r.t. a (written to grad, same shape as a).
+    // One pass over the logits, parallel over rows. partial is scratch of at least
+    // loss_chunks(a.rows, a.cols) floats, owned by the caller so no call allocates.
+    float loss_and_grad(LossType l, const TensorView& a, const TensorView& b, TensorView grad, float* partial);
     
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include <model/ModelFile.h>
+#include <runtime/MappedFile.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace wolf {
+    ModelFileReader::ModelFileReader(const std::string& path, const char* who)
+            : file(std::make_shared<runtime::MappedFile>(path)) {
+        const std::byte* base = file->data();
+        const size_t size = file->size();
+
+        const auto& magic = ModelFileHeader::expected_magic;
+        if (size < magic.size() || std::memcmp(base, magic.data(), magic.size()) != 0) {
+            stream = true;
+            return;
+        }
+        if (size < sizeof(header)) {
+            throw std::runtime_error(std::string(who) + ": truncated model file " + path);
+        }
+        std::memcpy(&header, base, sizeof(header));
+        if (header.version != ModelFileHeader::current_version) {
+            throw std::runtime_error(std::string(who) + ": unsupported model file version in " + path);
+        }
+        const size_t table_end = sizeof(header) + size_t{header.num_layers} * sizeof(LayerRecord);
+        // Each test relies on the ones before it: shapes_offset + shapes_size <= size cannot wrap
+        if (table_end > size
+                || header.shapes_offset < table_end
+                || header.shapes_offset > size
+                || header.shapes_size > size - header.shapes_offset
+                || header.params_offset % tensor_alignment != 0
+                || header.params_offset < header.shapes_offset + header.shapes_size
+                || header.params_floats > (size - std::min<size_t>(size, header.params_offset)) / sizeof(float)) {
+            throw std::runtime_error(std::string(who) + ": corrupt model file " + path);
+        }
+
+        records.resize(header.num_layers);
+        size_t offset = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            LayerRecord& rec = records[i];
+            std::memcpy(&rec, base + sizeof(header) + i * sizeof(LayerRecord), sizeof(rec));
+            if (rec.shape_size > header.shapes_size || rec.shape_offset > header.shapes_size - rec.shape_size
+                    || rec.param_offset != offset || rec.param_count > header.params_floats - offset) {
+                throw std::runtime_error(std::string(who) + ": corrupt layer table in " + path);
+            }
+            offset += rec.param_count;
+        }
+    }
+
+    std::span<const std::byte> ModelFileReader::bytes() const {
+        return {file->data(), file->size()};
+    }
+
+    std::vector<std::byte> ModelFileReader::shape(size_t i) const {
+        const std::byte* s = file->data() + header.shapes_offset + records[i].shape_offset;
+        return {s, s + records[i].shape_size};
+    }
+
+    float* ModelFileReader::params() const {
+        return reinterpret_cast<float*>(file->data() + header.params_offset);
+    }
+}
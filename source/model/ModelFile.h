@@ -0,0 +1,76 @@
+#pragma once
+#include <math/aligned.h>
+#include <model/Layer.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace wolf::runtime { class MappedFile; }
+
+namespace wolf {
+
+// On-disk model, version 1. All integers in host byte order.
+//
+//   ModelFileHeader
+//   LayerRecord[num_layers]
+//   shape section: each layer's save_shape() output, back to back
+//   padding to tensor_alignment
+//   params section: the ParamArena Params region as bind_arena() lays it out
+//
+// The params section is mapped and viewed in place by Sequential::load, so a
+// loaded model costs no copy and processes loading the same file share its pages.
+// Files without the magic are read as the original zpp_bits stream.
+struct ModelFileHeader {
+    static constexpr std::array<char, 8> expected_magic{'W', 'O', 'L', 'F', 'M', 'D', 'L', '\0'};
+    static constexpr uint32_t current_version = 1;
+
+    std::array<char, 8> magic = expected_magic;
+    uint32_t version = current_version;
+    uint32_t num_layers = 0;
+    uint64_t shapes_offset = 0; // Bytes from the start of the file
+    uint64_t shapes_size = 0;
+    uint64_t params_offset = 0; // Multiple of tensor_alignment
+    uint64_t params_floats = 0;
+    uint64_t reserved[2] = {};
+};
+static_assert(sizeof(ModelFileHeader) == 64);
+
+struct LayerRecord {
+    LayerKind kind{};
+    uint8_t reserved[7] = {};
+    uint64_t shape_offset = 0; // Within the shape section
+    uint64_t shape_size = 0;
+    uint64_t param_offset = 0; // Floats into the params section
+    uint64_t param_count = 0;
+};
+static_assert(sizeof(LayerRecord) == 40);
+
+// A model file mapped and checked: header, layer table and section bounds. Errors are
+// runtime_errors prefixed with `who`.
+class ModelFileReader {
+public:
+    ModelFileReader(const std::string& path, const char* who);
+
+    // No magic: an original zpp_bits stream, of which only bytes() is meaningful.
+    bool is_stream() const { return stream; }
+    std::span<const std::byte> bytes() const;
+    size_t num_layers() const { return records.size(); }
+    // Records are contiguous: record(i).param_offset is the sum of the counts before it.
+    const LayerRecord& record(size_t i) const { return records[i]; }
+    std::vector<std::byte> shape(size_t i) const;
+    float* params() const;
+    size_t params_floats() const { return header.params_floats; }
+    // Keeps params() valid.
+    const std::shared_ptr<runtime::MappedFile>& mapped() const { return file; }
+
+private:
+    std::shared_ptr<runtime::MappedFile> file;
+    ModelFileHeader header;
+    std::vector<LayerRecord> records;
+    bool stream = false;
+};
+
+}
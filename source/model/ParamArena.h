@@ -0,0 +1,81 @@
+#pragma once
+#include <math/aligned.h>
+#include <math/tensor.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace wolf {
+
+// One flat home for the parameters of a model and their optimizer state.
+// All regions share one layout, so the offset of a parameter tensor also
+// addresses its gradient and moments. Every slot starts 64-byte aligned.
+class ParamArena {
+public:
+    enum Region : uint8_t {
+        Params,
+        Grads,
+        Moment1, // Momentum velocity, Adam first moment
+        Moment2, // RMSProp mean square, Adam second moment
+    };
+    static constexpr size_t num_regions = 4;
+
+    ParamArena() = default;
+    explicit ParamArena(size_t n) : n(n) {
+        for (size_t r = 0; r < num_regions; ++r) {
+            owned[r] = AlignedBuffer(n);
+            regions[r] = owned[r].data();
+        }
+    }
+    // Shares master's parameters and owns only its own gradients; no optimizer state.
+    // Used by data-parallel workers, which never step.
+    static ParamArena replica(ParamArena& master) {
+        ParamArena a;
+        a.n = master.n;
+        a.owned[Grads] = AlignedBuffer(a.n);
+        a.regions[Params] = master.region(Params);
+        a.regions[Grads] = a.owned[Grads].data();
+        return a;
+    }
+    // Parameters that live in memory the arena does not own (a mapped model file),
+    // kept alive by backing. The other regions stay null until allocate_missing().
+    static ParamArena external(float* params, size_t n, std::shared_ptr<void> backing) {
+        ParamArena a;
+        a.n = n;
+        a.regions[Params] = params;
+        a.backing = std::move(backing);
+        return a;
+    }
+    // Zero-filled storage for every region that is still null.
+    void allocate_missing() {
+        for (size_t r = 0; r < num_regions; ++r) {
+            if (regions[r] == nullptr) {
+                owned[r] = AlignedBuffer(n);
+                regions[r] = owned[r].data();
+            }
+        }
+    }
+    // Copies from[from_offset, from_offset + n) to [to_offset, to_offset + n) in every
+    // region from has; the others keep what they hold.
+    void copy_slot(const ParamArena& from, size_t from_offset, size_t to_offset, size_t n) {
+        for (size_t r = 0; r < num_regions; ++r) {
+            if (from.regions[r] != nullptr) {
+                std::copy_n(from.regions[r] + from_offset, n, regions[r] + to_offset);
+            }
+        }
+    }
+    size_t size() const { return n; } // Floats per region
+    float* region(Region r) { return regions[r]; } // Null for regions a replica lacks
+    TensorView view(Region r, size_t offset, size_t rows, size_t cols) {
+        return regions[r] != nullptr ? TensorView{regions[r] + offset, rows, cols} : TensorView{};
+    }
+
+private:
+    std::array<AlignedBuffer, num_regions> owned;
+    std::array<float*, num_regions> regions{};
+    std::shared_ptr<void> backing;
+    size_t n = 0;
+};
+
+}
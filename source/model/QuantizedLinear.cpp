@@ -0,0 +1,86 @@
+#include <model/QuantizedLinear.h>
+#include <math/parallel.h>
+#include <math/simd/simd.h>
+#include <algorithm>
+#include <cmath>
+
+namespace wolf {
+    namespace {
+        // Output columns per task; 64 int32 accumulators stay in L1.
+        constexpr size_t col_block = 64;
+
+        // Symmetric quantization of x[0], x[step], ... (n of them) to [-127, 127]; returns the scale.
+        float quantize_row(const float* x, size_t step, int8_t* q, size_t n) {
+            float amax = 0.0f;
+            for (size_t i = 0; i < n; ++i) {
+                amax = std::max(amax, std::fabs(x[i * step]));
+            }
+            const float scale = amax > 0.0f ? amax / 127.0f : 1.0f;
+            const float inv = 1.0f / scale;
+            for (size_t i = 0; i < n; ++i) {
+                q[i] = static_cast<int8_t>(std::clamp(std::nearbyint(x[i * step] * inv), -127.0f, 127.0f));
+            }
+            return scale;
+        }
+    }
+
+    QuantizedLinear::QuantizedLinear(const LinearLayer& linear, Activation act)
+            : Layer(LayerKind::QuantizedLinear), x_dim(linear.in_size()), y_dim(linear.out_size()), act(act),
+              Wq(x_dim * y_dim), w_scale(y_dim) {
+        const Tensor W = linear.weights();
+        const Tensor bias = linear.bias();
+        for (size_t y = 0; y < y_dim; ++y) {
+            w_scale[y] = quantize_row(W.data().data() + y * x_dim, 1, Wq.data() + y * x_dim, x_dim);
+        }
+        b.assign(bias.data().begin(), bias.data().end());
+    }
+
+    QuantizedLinear::QuantizedLinear(size_t x_dim, size_t y_dim, Activation act,
+                                     std::vector<int8_t> Wq, std::vector<float> w_scale, std::vector<float> b)
+            : Layer(LayerKind::QuantizedLinear), x_dim(x_dim), y_dim(y_dim), act(act),
+              Wq(std::move(Wq)), w_scale(std::move(w_scale)), b(std::move(b)) {}
+
+    void QuantizedLinear::forward_into(const TensorView& x, TensorView out) {
+        if (xq.size() < x.rows * x_dim) {
+            xq.resize(x.rows * x_dim);
+        }
+        if (x_scale.size() < x.rows) {
+            x_scale.resize(x.rows);
+        }
+        run(x, out, xq.data(), x_scale.data());
+    }
+
+    void QuantizedLinear::infer(const TensorView& x, TensorView out, InferenceContext& ctx) const {
+        const size_t xq_bytes = align_floats(x.rows * x_dim) * sizeof(float); // Keeps the scales aligned
+        std::byte* scratch = ctx.scratch(xq_bytes + x.rows * sizeof(float));
+        run(x, out, reinterpret_cast<int8_t*>(scratch), reinterpret_cast<float*>(scratch + xq_bytes));
+    }
+
+    void QuantizedLinear::run(const TensorView& x, TensorView out, int8_t* xq, float* xs) const {
+        const size_t rows = x.rows;
+        parallel_chunks(rows, std::max<size_t>(1, elementwise_grain / std::max<size_t>(1, x_dim)), [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; ++r) {
+                xs[r] = quantize_row(x.data + r * x.stride, x.col_stride, xq + r * x_dim, x_dim);
+            }
+        });
+
+        // One task per (row, block of output columns)
+        const auto& k = simd::kernels();
+        const size_t blocks = (y_dim + col_block - 1) / col_block;
+        runtime::parallel_for(rows * blocks, 1, [&](size_t t, size_t) {
+            const size_t r = t / blocks;
+            const size_t j0 = (t % blocks) * col_block;
+            const size_t n = std::min(col_block, y_dim - j0);
+            int32_t acc[col_block];
+            k.dot_s8(xq + r * x_dim, Wq.data() + j0 * x_dim, x_dim, n, x_dim, acc);
+
+            // Dequantize, add bias, activate
+            float* o = out.row(r) + j0;
+            const float s = xs[r];
+            for (size_t j = 0; j < n; ++j) {
+                const float v = static_cast<float>(acc[j]) * s * w_scale[j0 + j] + b[j0 + j];
+                o[j] = act == Activation::ReLU && v < 0.0f ? 0.0f : v;
+            }
+        });
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <model/Layer.h>
+#include <model/LinearLayer.h>
+#include <math/gemm.h>
+#include <external/zpp_bits.h>
+#include <cstdint>
+#include <stdexcept>
+
+namespace wolf {
+
+// Inference-only int8 version of a trained LinearLayer, built by Sequential::quantize().
+// Weights are symmetric int8 with one scale per output channel; each input row is
+// quantized on the fly with its own scale. The int32 dot products are dequantized
+// together with the bias and the optional activation in one pass over the output.
+class QuantizedLinear : public Layer {
+public:
+    QuantizedLinear(const LinearLayer& linear, Activation act);
+    QuantizedLinear(size_t x_dim, size_t y_dim, Activation act,
+                    std::vector<int8_t> Wq, std::vector<float> w_scale, std::vector<float> b);
+
+    size_t out_cols(size_t) const override { return y_dim; }
+    void forward_into(const TensorView& x, TensorView out) override;
+    void infer(const TensorView& x, TensorView out, InferenceContext& ctx) const override;
+    void backward_into(const TensorView&, TensorView) override {
+        throw std::logic_error("QuantizedLinear is inference-only");
+    }
+    void step_SGD(float lr, size_t batch_size) override {}
+    void step_momentum(float lr, float mu, size_t batch_size) override {}
+    void step_RMSProp(float lr, float alpha, float eps, size_t batch_size) override {}
+    void step_Adam(float lr, float beta1, float beta2, float eps, float bc1, float bc2, size_t batch_size) override {}
+    bool owns_cache() const override { return true; } // Keeps nothing
+    // Input quantization, the int8 dot products and the dequantizing epilogue
+    LayerCost cost(runtime::Phase phase, size_t rows, size_t) const override {
+        if (phase != runtime::Phase::Forward) {
+            return {};
+        }
+        const double r = static_cast<double>(rows);
+        const double xy = static_cast<double>(x_dim * y_dim);
+        return {2.0 * r * xy + 3.0 * r * x_dim + 3.0 * r * y_dim, xy + 8.0 * y_dim + r * (9.0 * x_dim + 4.0 * y_dim)};
+    }
+    std::unique_ptr<Layer> replicate(ParamArena&, size_t) const override {
+        return std::make_unique<QuantizedLinear>(x_dim, y_dim, act, Wq, w_scale, b);
+    }
+    size_t in_size() const {return x_dim;}
+    size_t out_size() const {return y_dim;}
+    Activation activation() const {return act;}
+
+    void save_body(zpp::bits::out<std::vector<std::byte>>& out) const override {
+        out(x_dim, y_dim, act, Wq, w_scale, b).or_throw();
+    }
+    static std::unique_ptr<Layer> load_from(zpp::bits::in<std::vector<std::byte>>& in) {
+        std::size_t x_dim{}, y_dim{};
+        Activation act{};
+        std::vector<int8_t> Wq;
+        std::vector<float> w_scale, b;
+        in(x_dim, y_dim, act, Wq, w_scale, b).or_throw();
+        if (Wq.size() != x_dim * y_dim || w_scale.size() != y_dim || b.size() != y_dim) {
+            throw std::runtime_error("QuantizedLinear::load_from: weight size mismatch");
+        }
+        return std::make_unique<QuantizedLinear>(x_dim, y_dim, act, std::move(Wq), std::move(w_scale), std::move(b));
+    }
+
+private:
+    // xq: [x.rows x in_dim] for the quantized input, xs: [x.rows] for its scales
+    void run(const TensorView& x, TensorView out, int8_t* xq, float* xs) const;
+
+    size_t x_dim;
+    size_t y_dim;
+    Activation act;
+    std::vector<int8_t> Wq;     // [out_dim x in_dim] in [-127, 127]
+    std::vector<float> w_scale; // [out_dim], W ~= Wq * w_scale
+    std::vector<float> b;       // [out_dim], fp32
+    std::vector<int8_t> xq;     // Quantized input rows
+    std::vector<float> x_scale; // One per input row
+};
+
+}
@@ -1,24 +1,47 @@
     #include <model/ReLU.h>
+    #include <math/simd/simd.h>
 
     namespace wolf {
-        Tensor ReLULayer::forward(const Tensor& x) {
-            last_input = x;
-            std::vector<float> out(x.ncols() * x.nrows());
-            for (size_t i = 0; i < x.ncols() * x.nrows(); i++) {
-                if (x(i) < 0) {
-                    out[i] = 0;
-                } else {
-                    out[i] = x(i);
+        namespace {
+            // x row-major. One kernel call when x and out are both contiguous, else one per row.
+            void relu(const TensorView& x, TensorView out) {
+                const auto& k = simd::kernels();
+                if (x.contiguous() && out.contiguous()) {
+                    k.relu(x.data, out.data, x.rows * x.cols);
+                    return;
+                }
+                for (size_t r = 0; r < x.rows; ++r) {
+                    k.relu(x.row(r), out.row(r), x.cols);
                 }
             }
-            return Tensor(out, x.nrows(), x.ncols());
         }
 
-        Tensor ReLULayer::backward(const Tensor& grad_out) {
-            std::vector<float> gx(last_input.size());
-            for (size_t i = 0; i < last_input.size(); i++) {
-                gx[i] = (last_input[i] > 0.0f) ? grad_out[i] : 0.0f;
+        void ReLULayer::forward_into(const TensorView& x, TensorView out) {
+            last_input = grad_enabled ? x : TensorView{};
+            relu(row_major(x, rows_tmp), out);
+        }
+
+        void ReLULayer::infer(const TensorView& x, TensorView out, InferenceContext& ctx) const {
+            if (x.row_major()) {
+                relu(x, out);
+                return;
+            }
+            // Column-major input: gathered in the context's scratch, so infer stays reentrant
+            TensorView xr{reinterpret_cast<float*>(ctx.scratch(x.size() * sizeof(float))), x.rows, x.cols};
+            copy_view(x, xr);
+            relu(xr, out);
+        }
+
+        void ReLULayer::backward_into(const TensorView& grad_out, TensorView grad_in) {
+            const auto& k = simd::kernels();
+            if (last_input.contiguous() && grad_out.contiguous() && grad_in.contiguous()) {
+                k.relu_backward(last_input.data, grad_out.data, grad_in.data, last_input.rows * last_input.cols);
+                return;
+            }
+            const TensorView x = row_major(last_input, rows_tmp);
+            const TensorView g = row_major(grad_out, grad_tmp);
+            for (size_t r = 0; r < x.rows; ++r) {
+                k.relu_backward(x.row(r), g.row(r), grad_in.row(r), x.cols);
             }
-            return Tensor(gx, last_input.nrows(), last_input.ncols());
         }
-    }
\ No newline at end of file
+    }
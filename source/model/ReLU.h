@@ -7,21 +7,30 @@ namespace wolf {
 
 class ReLULayer : public Layer {
 public:
-    Tensor forward(const Tensor& x) override;
-    Tensor backward(const Tensor& grad_out) override;
+    size_t out_cols(size_t in_cols) const override { return in_cols; }
+    void forward_into(const TensorView& x, TensorView out) override;
+    void infer(const TensorView& x, TensorView out, InferenceContext&) const override;
+    void backward_into(const TensorView& grad_out, TensorView grad_in) override;
+    LayerCost cost(runtime::Phase phase, size_t rows, size_t in_cols) const override {
+        const double n = static_cast<double>(rows * in_cols);
+        return {n, (phase == runtime::Phase::Forward ? 8.0 : 12.0) * n};
+    }
 
     void step_SGD(float lr, size_t batch_size) override {}
     void step_momentum(float lr, float mu, size_t batch_size) override {}
     void step_RMSProp(float lr, float alpha, float eps, size_t batch_size) override {}
     void step_Adam(float lr, float beta1, float beta2, float eps, float bc1, float bc2, size_t batch_size) override {}
     void save_body(zpp::bits::out<std::vector<std::byte>>& out) const override {}
+    std::unique_ptr<Layer> replicate(ParamArena&, size_t) const override { return std::make_unique<ReLULayer>(); }
     ReLULayer() : Layer(LayerKind::ReLU) {}
     static std::unique_ptr<Layer> load_from(zpp::bits::in<std::vector<std::byte>>& in) {
         return std::make_unique<ReLULayer>();
     }
 
 private:
-    Tensor last_input;
+    TensorView last_input; // owned by the caller
+    AlignedVector rows_tmp; // Column-major inputs gathered into rows
+    AlignedVector grad_tmp;
 };
 
 }
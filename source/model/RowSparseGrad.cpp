@@ -0,0 +1,35 @@
+#include <model/RowSparseGrad.h>
+#include <iterator>
+
+namespace wolf {
+    void RowSparseGrad::accumulate(float* grad, size_t width) {
+        std::ranges::sort(entries, {}, &Entry::row);
+        active.clear();
+        group_start.clear();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (i == 0 || entries[i].row != entries[i - 1].row) {
+                active.push_back(entries[i].row);
+                group_start.push_back(i);
+            }
+        }
+        group_start.push_back(entries.size());
+
+        parallel_chunks(active.size(), std::max<size_t>(1, elementwise_grain / width), [&](size_t g0, size_t g1) {
+            for (size_t g = g0; g < g1; ++g) {
+                float* dst = grad + size_t{active[g]} * width;
+                for (size_t i = group_start[g]; i < group_start[g + 1]; ++i) {
+                    const float s = entries[i].scale;
+                    const float* src = entries[i].src;
+                    for (size_t j = 0; j < width; ++j) {
+                        dst[j] += s * src[j];
+                    }
+                }
+            }
+        });
+        entries.clear();
+
+        merged.clear();
+        std::ranges::set_union(rows, active, std::back_inserter(merged));
+        rows.swap(merged);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <model/Layer.h>
+#include <math/parallel.h>
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace wolf {
+
+// Gradient of a [rows x width] parameter matrix of which a batch only touches a few rows
+// (embedding tables, feature-major sparse weights), and the rows touched since the last
+// optimizer update, for SparseRows.
+class RowSparseGrad {
+public:
+    // Queues grad[row] += scale * src[0, width); src must stay valid until accumulate().
+    void add(uint32_t row, const float* src, float scale) { entries.push_back({row, scale, src}); }
+    // Sums the queued contributions into grad, in parallel over distinct rows so no two
+    // threads write the same row, and adds those rows to touched().
+    void accumulate(float* grad, size_t width);
+    // Sorted, distinct.
+    std::span<const uint32_t> touched() const { return rows; }
+    void clear_touched() { rows.clear(); }
+
+private:
+    struct Entry {
+        uint32_t row;
+        float scale;
+        const float* src;
+    };
+    std::vector<Entry> entries;
+    std::vector<uint32_t> active;     // Distinct rows of entries, sorted
+    std::vector<size_t> group_start;  // First entry of each active row
+    std::vector<uint32_t> rows;
+    std::vector<uint32_t> merged;
+};
+
+// Calls fn(offset, n) over the parameter ranges of a layer's update, offsets in floats from
+// its first parameter: every float of its param_count() = total, or with s.row_floats != 0
+// only the touched rows and [s.dense_from, total). Runs in parallel.
+template <class F>
+void for_each_update_range(const SparseRows& s, size_t total, F&& fn) {
+    if (s.row_floats == 0) {
+        parallel_chunks(total, elementwise_grain, [&](size_t i0, size_t i1) { fn(i0, i1 - i0); });
+        return;
+    }
+    parallel_chunks(s.rows.size(), std::max<size_t>(1, elementwise_grain / s.row_floats), [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; ++r) {
+            fn(size_t{s.rows[r]} * s.row_floats, s.row_floats);
+        }
+    });
+    if (s.dense_from < total) {
+        fn(s.dense_from, total - s.dense_from);
+    }
+}
+
+}
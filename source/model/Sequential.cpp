@@ -1,11 +1,101 @@
 #include <model/Sequential.h>
 #include <external/zpp_bits.h>
+#include <filesystem>
 #include <fstream>
 #include <model/LayerSaver.h>
+#include <model/FusedLinearReLU.h>
+#include <model/QuantizedLinear.h>
+#include <model/ModelFile.h>
 #include <model/optimizers.h>
+#include <math/simd/simd.h>
+#include <math/parallel.h>
+#include <runtime/ThreadPool.h>
+#include <runtime/MappedFile.h>
+#include <runtime/ProcessGroup.h>
+#include <runtime/Profiler.h>
+#include <algorithm>
 #include <cmath>
 
 namespace wolf {
+    namespace {
+        // Times the enclosing scope as one event of a profile slot. cost() is only called in
+        // WOLF_PROFILE builds; otherwise the probe does nothing and is optimized away.
+        template <class CostFn>
+        class Probe {
+        public:
+            Probe(runtime::Profiler& p, runtime::Phase phase, size_t slot, CostFn cost)
+                : profiler(p), phase(phase), slot(slot), cost(cost) {
+                if constexpr (runtime::profiling) {
+                    wait0 = runtime::thread_wait_ns();
+                    start = profiler.now_ns();
+                }
+            }
+            ~Probe() {
+                if constexpr (runtime::profiling) {
+                    const uint64_t end = profiler.now_ns();
+                    const LayerCost c = cost();
+                    profiler.record({phase, static_cast<uint32_t>(slot), runtime::thread_index(),
+                                     start, end - start, runtime::thread_wait_ns() - wait0, c.flops, c.bytes});
+                }
+            }
+            Probe(const Probe&) = delete;
+            Probe& operator=(const Probe&) = delete;
+
+        private:
+            runtime::Profiler& profiler;
+            runtime::Phase phase;
+            size_t slot;
+            CostFn cost;
+            uint64_t start = 0;
+            uint64_t wait0 = 0;
+        };
+
+        const char* kind_name(LayerKind k) {
+            switch (k) {
+                case LayerKind::Linear: return "Linear";
+                case LayerKind::ReLU: return "ReLU";
+                case LayerKind::LinearReLU: return "LinearReLU";
+                case LayerKind::QuantizedLinear: return "QuantizedLinear";
+                case LayerKind::SparseLinear: return "SparseLinear";
+                case LayerKind::Embedding: return "Embedding";
+            }
+            return "Layer";
+        }
+
+        // Queues the optimizer update of one exec entry's arena slot [offset, offset + count):
+        // all of it, or the rows its sparse backward touched plus its dense tail.
+        template <class Slice, class Rows>
+        void queue_update(runtime::TaskGroup& updates, size_t offset, size_t count, const SparseRows& sparse,
+                          Slice& slice, Rows& rows) {
+            if (sparse.row_floats == 0) {
+                updates.run(offset, offset + count, elementwise_grain, slice);
+                return;
+            }
+            updates.run(0, sparse.rows.size(), std::max<size_t>(1, elementwise_grain / sparse.row_floats), rows);
+            updates.run(offset + sparse.dense_from, offset + count, elementwise_grain, slice);
+        }
+
+        void forward_first(Layer& l, const SparseView& x, TensorView out) { l.forward_sparse(x, out); }
+        void forward_first(Layer& l, const IndexView& x, TensorView out) { l.forward_indices(x, out); }
+
+        // Every array the update reads is also written back.
+        LayerCost step_cost(const OptimVariant& opt, size_t n) {
+            const double f = static_cast<double>(n);
+            return std::visit([&](const auto& o) -> LayerCost {
+                using Opt = std::decay_t<decltype(o)>;
+                if constexpr (std::is_same_v<Opt, SGD>) {
+                    return {2.0 * f, 16.0 * f};
+                } else if constexpr (std::is_same_v<Opt, Momentum>) {
+                    return {4.0 * f, 24.0 * f};
+                } else if constexpr (std::is_same_v<Opt, RMSProp>) {
+                    return {7.0 * f, 24.0 * f};
+                } else {
+                    return {12.0 * f, 32.0 * f};
+                }
+            }, opt);
+        }
+    }
+
     void Sequential::set_optimizer(OptimVariant cfg) {
         optim_cfg = std::move(cfg);
         step_t = 0;
@@ -19,24 +109,342 @@ namespace wolf {
         return out;
     }
 
-    TensorView Sequential::pred(TensorView x) {
+    // Fusion pass: replaces every Linear -> ReLU pair in the execution plan.
+    void Sequential::fuse_layers() {
+        exec.clear();
+        exec_params.clear();
+        fused.clear();
+        size_t offset = 0; // Same layout as bind_arena()
+        for (size_t i = 0; i < layers.size(); ++i) {
+            const bool pair = i + 1 < layers.size()
+                           && layers[i]->kind() == LayerKind::Linear
+                           && layers[i + 1]->kind() == LayerKind::ReLU;
+            size_t count = layers[i]->param_count();
+            if (fusion && pair) {
+                fused.push_back(std::make_unique<FusedLinearReLU>(static_cast<LinearLayer&>(*layers[i])));
+                fused.back()->set_grad_enabled(grad_enabled);
+                exec.push_back(fused.back().get());
+                ++i;
+                count += layers[i]->param_count();
+            } else {
+                exec.push_back(layers[i].get());
+            }
+            exec_params.emplace_back(offset, count);
+            offset += count;
+        }
+    }
+
+    void Sequential::set_precision(Precision p) {
+        precision = p;
+        for (auto& l : layers) {
+            l->set_precision(p);
+        }
+        for (auto& r : replicas) {
+            r->set_precision(p);
+        }
+        cols.clear(); // Which activations must be kept depends on it
+    }
 
-        if (fbuf.empty() || fbuf.nrows() < x.rows || fbuf.ncols() < x.cols) {
-            fbuf = Tensor(std::move(std::vector<float>(x.rows * x.cols)), x.rows, x.cols);
-        } 
-        std::copy_n(x.data, x.cols * x.rows, fbuf.data().begin());
-        fbuf.set_cols(x.cols);
-        fbuf.set_rows(x.rows);
-        
+    void Sequential::quantize() {
+        // The plan, fused layers and replicas refer to the layers replaced below
+        exec.clear();
+        fused.clear();
+        replicas.clear();
+        std::vector<std::unique_ptr<Layer>> quantized;
+        for (size_t i = 0; i < layers.size(); ++i) {
+            if (layers[i]->kind() != LayerKind::Linear) {
+                quantized.push_back(std::move(layers[i]));
+                continue;
+            }
+            const auto& linear = static_cast<const LinearLayer&>(*layers[i]);
+            const bool relu = i + 1 < layers.size() && layers[i + 1]->kind() == LayerKind::ReLU;
+            quantized.push_back(std::make_unique<QuantizedLinear>(linear, relu ? Activation::ReLU : Activation::None));
+            if (relu) {
+                ++i;
+            }
+        }
+        // Layers kept as they are (SparseLinear, Embedding) view the old arena: they move
+        // to a new one, sized for them alone, before it goes
+        const std::unique_ptr<ParamArena> old_arena = std::move(arena);
+        layers = std::move(quantized);
+        for (auto& l : layers) {
+            l->set_grad_enabled(grad_enabled);
+        }
+        bind_arena();
+        cols.clear();
+        plan_rows = 0;
+        infer_rows = 0;
+    }
+
+    void Sequential::params_changed() {
+        for (auto& l : layers) {
+            l->params_changed();
+        }
+        for (auto& r : replicas) {
+            r->params_changed();
+        }
+    }
+
+    void Sequential::set_fusion(bool on) {
+        fusion = on;
+        for (auto& r : replicas) {
+            r->set_fusion(on);
+        }
+        exec.clear();
+        cols.clear();
+    }
+
+    void Sequential::plan_cols(size_t in_cols) {
+        if (!cols.empty() && cols.front() == in_cols) {
+            return;
+        }
+        fuse_layers();
+        cols.assign(1, in_cols);
+        for (Layer* l : exec) {
+            cols.push_back(l->out_cols(cols.back()));
+        }
+        plan_rows = 0;
+        infer_rows = 0;
+        if constexpr (runtime::profiling) {
+            describe_profile();
+        }
+    }
+
+    // One profile slot per exec entry, then "model".
+    void Sequential::describe_profile() {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < exec.size(); ++i) {
+            names.push_back(std::to_string(i) + " " + kind_name(exec[i]->kind()) + " "
+                            + std::to_string(cols[i]) + "x" + std::to_string(cols[i + 1]));
+        }
+        names.emplace_back("model");
+        profiler->describe(std::move(names));
+    }
+
+    // Moves all parameters into one arena so step() is a single pass over it.
+    void Sequential::bind_arena() {
+        size_t total = 0;
         for (auto& l : layers) {
-            fbuf = l->forward(fbuf);
+            total += l->param_count();
+        }
+        arena = std::make_unique<ParamArena>(total);
+        size_t offset = 0;
+        for (auto& l : layers) {
+            l->bind_params(*arena, offset);
+            offset += l->param_count();
+        }
+    }
+
+    // A loaded model maps only its parameters; gradients and optimizer state
+    // are allocated the first time it trains.
+    void Sequential::ensure_arena() {
+        if (!arena) {
+            bind_arena();
+            return;
+        }
+        if (arena->region(ParamArena::Grads) == nullptr) {
+            arena->allocate_missing();
+            size_t offset = 0;
+            for (auto& l : layers) {
+                l->bind_params(*arena, offset);
+                offset += l->param_count();
+            }
+        }
+    }
+
+    void Sequential::init(size_t max_batch, size_t in_cols, bool sparse_input) {
+        ensure_arena();
+        plan_cols(in_cols);
+        // An output needs its own buffer only while the next layer keeps a view of it;
+        // the rest alternate between two shared buffers.
+        acts.assign(exec.size(), Tensor{});
+        size_t shared_cols = 0;
+        for (size_t i = 0; i < exec.size(); ++i) {
+            if (i + 1 < exec.size() && !exec[i + 1]->owns_cache()) {
+                acts[i] = Tensor(max_batch, cols[i + 1]);
+            } else {
+                shared_cols = std::max(shared_cols, cols[i + 1]);
+            }
+        }
+        for (auto& buf : shared_acts) {
+            buf = Tensor(max_batch, shared_cols);
+        }
+        // Backward writes the gradient of every layer's input, except the first one's
+        // when that input is sparse
+        const size_t widest = sparse_input ? widest_output() : std::max(cols.front(), widest_output());
+        for (auto& buf : bbuf) {
+            buf = Tensor(max_batch, widest);
+        }
+        grad_y = Tensor(max_batch, cols.back());
+        loss_partial.assign(loss_chunks(max_batch, cols.back()), 0.0f);
+        plan_rows = max_batch;
+        plan_sparse = sparse_input;
+    }
+
+    size_t Sequential::widest_output() const {
+        return cols.size() < 2 ? 0 : *std::max_element(cols.begin() + 1, cols.end());
+    }
+
+    void Sequential::init_inference(size_t max_batch, size_t in_cols) {
+        plan_cols(in_cols);
+        // Only layer outputs go through fbuf; the input is read where it is
+        const size_t widest = widest_output();
+        for (auto& buf : fbuf) {
+            buf = Tensor(max_batch, widest);
+        }
+        infer_rows = max_batch;
+    }
+
+    void Sequential::set_grad_enabled(bool on) {
+        grad_enabled = on;
+        for (auto& l : layers) {
+            l->set_grad_enabled(on);
+        }
+        for (auto& l : fused) {
+            l->set_grad_enabled(on);
+        }
+    }
+
+    TensorView Sequential::pred(TensorView x) {
+        if (!grad_enabled) {
+            return pred_inference(x);
+        }
+        if (x.rows > plan_rows || cols.empty() || x.cols != cols.front() || plan_sparse) {
+            init(x.rows, x.cols);
+        }
+        batch_rows = x.rows;
+        sparse_in = false;
+        return forward_from(0, x);
+    }
+
+    TensorView Sequential::pred(const SparseView& x) {
+        return pred_first(x);
+    }
+
+    TensorView Sequential::pred(const IndexView& x) {
+        return pred_first(x);
+    }
+
+    // Sparse or index input: only exec[0] reads it, the rest of the model is as usual.
+    template <class Input>
+    TensorView Sequential::pred_first(const Input& x) {
+        if (!grad_enabled) {
+            return pred_inference(x);
+        }
+        if (x.rows > plan_rows || cols.empty() || x.cols != cols.front() || !plan_sparse) {
+            init(x.rows, x.cols, true);
+        }
+        if (exec.empty()) {
+            throw std::logic_error("Sequential::pred: sparse input needs a first layer");
+        }
+        batch_rows = x.rows;
+        sparse_in = true;
+        sparse_nnz = x.nnz();
+        TensorView out{(acts[0].empty() ? shared_acts[0] : acts[0]).data().data(), x.rows, cols[1]};
+        {
+            Probe probe(*profiler, runtime::Phase::Forward, 0,
+                        [&] { return exec[0]->sparse_cost(runtime::Phase::Forward, x.rows, x.nnz()); });
+            forward_first(*exec[0], x, out);
+        }
+        return forward_from(1, out);
+    }
+
+    // Runs exec[first, ...) on cur, the output of exec[first - 1] (or the input).
+    TensorView Sequential::forward_from(size_t first, TensorView cur) {
+        for (size_t i = first; i < exec.size(); ++i) {
+            Tensor& buf = acts[i].empty() ? shared_acts[i % 2] : acts[i];
+            TensorView out{buf.data().data(), cur.rows, cols[i + 1]};
+            Probe probe(*profiler, runtime::Phase::Forward, i,
+                        [&] { return exec[i]->cost(runtime::Phase::Forward, cur.rows, cols[i]); });
+            exec[i]->forward_into(cur, out);
+            cur = out;
+        }
+        return cur;
+    }
+
+    TensorView Sequential::pred_inference(TensorView x) {
+        auto no_grad = inference_mode();
+        if (x.rows > infer_rows || cols.empty() || x.cols != cols.front()) {
+            init_inference(x.rows, x.cols);
+        }
+        return infer_from(0, x);
+    }
+
+    TensorView Sequential::pred_inference(const SparseView& x) {
+        return infer_first(x);
+    }
+
+    TensorView Sequential::pred_inference(const IndexView& x) {
+        return infer_first(x);
+    }
+
+    template <class Input>
+    TensorView Sequential::infer_first(const Input& x) {
+        auto no_grad = inference_mode();
+        if (x.rows > infer_rows || cols.empty() || x.cols != cols.front()) {
+            init_inference(x.rows, x.cols);
+        }
+        if (exec.empty()) {
+            throw std::logic_error("Sequential::pred_inference: sparse input needs a first layer");
+        }
+        TensorView out{fbuf[0].data().data(), x.rows, cols[1]};
+        {
+            Probe probe(*profiler, runtime::Phase::Forward, 0,
+                        [&] { return exec[0]->sparse_cost(runtime::Phase::Forward, x.rows, x.nnz()); });
+            forward_first(*exec[0], x, out);
+        }
+        return infer_from(1, out);
+    }
+
+    TensorView Sequential::infer_from(size_t first, TensorView cur) {
+        for (size_t i = first; i < exec.size(); ++i) {
+            TensorView out{fbuf[i % 2].data().data(), cur.rows, cols[i + 1]};
+            Probe probe(*profiler, runtime::Phase::Forward, i,
+                        [&] { return exec[i]->cost(runtime::Phase::Forward, cur.rows, cols[i]); });
+            exec[i]->forward_into(cur, out);
+            cur = out;
         }
-        
-        return TensorView{fbuf};
+        return cur;
     }
     
     
+    TensorView Sequential::pred(TensorView x, InferenceContext& ctx) const {
+        TensorView cur = x;
+        for (size_t i = 0, step = 0; i < layers.size(); ++i, ++step) {
+            const size_t cols = layers[i]->out_cols(cur.cols);
+            AlignedBuffer& buf = ctx.acts[step % 2];
+            if (buf.size() < x.rows * cols) {
+                buf = AlignedBuffer(x.rows * cols);
+            }
+            TensorView out{buf.data(), x.rows, cols};
+            // Same Linear -> ReLU fusion as the execution plan, without building one
+            const bool pair = fusion && i + 1 < layers.size()
+                           && layers[i]->kind() == LayerKind::Linear
+                           && layers[i + 1]->kind() == LayerKind::ReLU;
+            Probe probe(*profiler, runtime::Phase::Forward, step, [&, first = i, in = cur.cols] {
+                LayerCost c = layers[first]->cost(runtime::Phase::Forward, x.rows, in);
+                if (pair) {
+                    const LayerCost act = layers[first + 1]->cost(runtime::Phase::Forward, x.rows, cols);
+                    c.flops += act.flops;
+                    c.bytes += act.bytes;
+                }
+                return c;
+            });
+            if (pair) {
+                static_cast<const LinearLayer&>(*layers[i]).infer_fused(cur, out, Activation::ReLU);
+                ++i;
+            } else {
+                layers[i]->infer(cur, out, ctx);
+            }
+            cur = out;
+        }
+        return cur;
+    }
+
     Tensor Sequential::backward(const Tensor& grad_y) {
+        if (!grad_enabled) {
+            throw std::runtime_error("Sequential::backward: called in inference mode");
+        }
         Tensor g = grad_y;
         for (std::size_t i = layers.size(); i-- > 0; ) {
             g = layers[i]->backward(g); 
@@ -45,141 +453,452 @@ namespace wolf {
     }
 
     TensorView Sequential::backward() {
-        for (std::size_t i = layers.size(); i-- > 0; ) {
-            bbuf = layers[i]->backward(bbuf); 
+        if (!grad_enabled) {
+            throw std::runtime_error("Sequential::backward: called in inference mode");
+        }
+        TensorView g{grad_y.data().data(), batch_rows, cols.back()};
+        for (std::size_t i = exec.size(); i-- > 0; ) {
+            backward_layer(i, g);
+        }
+        return g;
+    }
+
+    // Backpropagates g through exec[i]. Sparse input has no gradient: g is then left empty.
+    void Sequential::backward_layer(size_t i, TensorView& g) {
+        const bool sparse = i == 0 && sparse_in;
+        Probe probe(*profiler, runtime::Phase::Backward, i, [&] {
+            return sparse ? exec[0]->sparse_cost(runtime::Phase::Backward, batch_rows, sparse_nnz)
+                          : exec[i]->cost(runtime::Phase::Backward, batch_rows, cols[i]);
+        });
+        if (sparse) {
+            exec[0]->backward_sparse(g);
+            g = TensorView{};
+            return;
+        }
+        TensorView grad_in{bbuf[i % 2].data().data(), batch_rows, cols[i]};
+        exec[i]->backward_into(g, grad_in);
+        g = grad_in;
+    }
+
+    // backward() then step(), but each layer's update is queued as soon as its gradients
+    // are final and runs on idle threads while the layers below it backpropagate.
+    void Sequential::backward_and_step(size_t batch_size) {
+        if (!grad_enabled) {
+            throw std::runtime_error("Sequential::backward: called in inference mode");
+        }
+        if (!optim_cfg) {
+            throw std::runtime_error("Optimizer not set");
+        }
+        ensure_arena();
+        ++step_t;
+        float* grads = arena->region(ParamArena::Grads);
+        auto update_slice = [&](size_t i0, size_t i1) { update(grads, i0, i1, batch_size); };
+        SparseRows sparse; // Only the first layer can see sparse input
+        auto update_sparse = [&](size_t r0, size_t r1) {
+            update_rows(grads, exec_params[0].first, sparse.rows.subspan(r0, r1 - r0), sparse.row_floats, batch_size);
+        };
+
+        runtime::TaskGroup updates;
+        TensorView g{grad_y.data().data(), batch_rows, cols.back()};
+        for (std::size_t i = exec.size(); i-- > 0; ) {
+            backward_layer(i, g);
+            if (i == 0) {
+                sparse = exec[0]->touched_rows();
+            }
+            const auto [offset, count] = exec_params[i];
+            queue_update(updates, offset, count, i == 0 ? sparse : SparseRows{}, update_slice, update_sparse);
+        }
+        updates.wait();
+        params_changed();
+    }
+
+    // backward_and_step() for one rank of a process group. Each layer's gradients are
+    // queued for the all-reduce as soon as they are final; its update is queued once that
+    // is done and the global batch size is known. Returns the loss summed over the ranks.
+    float Sequential::backward_and_step_group(size_t rows, float loss) {
+        if (!grad_enabled) {
+            throw std::runtime_error("Sequential::backward: called in inference mode");
+        }
+        if (!optim_cfg) {
+            throw std::runtime_error("Optimizer not set");
         }
-        return TensorView{bbuf};
+        ensure_arena();
+        ++step_t;
+        float* grads = arena->region(ParamArena::Grads);
+        std::array<float, 2> totals{static_cast<float>(rows), loss};
+        const uint64_t totals_ticket = group->all_reduce_async(totals.data(), totals.size());
+        // The comm thread writes into totals and the gradients until its last ticket is
+        // done: if anything below throws, wait for it before unwinding (requests run in order)
+        uint64_t last_ticket = totals_ticket;
+        struct Drain {
+            runtime::ProcessGroup& group;
+            const uint64_t& last;
+            ~Drain() {
+                try {
+                    group.wait(last);
+                } catch (...) {
+                    // Already failed; the error that unwinds us matters more
+                }
+            }
+        } drain{*group, last_ticket};
+        std::vector<uint64_t> tickets(exec.size(), 0);
+        size_t batch_size = 0;
+        auto update_slice = [&](size_t i0, size_t i1) { update(grads, i0, i1, batch_size); };
+        auto no_rows = [](size_t, size_t) {};
+
+        runtime::TaskGroup updates;
+        size_t next = exec.size(); // Layers [next, end) have their update queued
+        auto queue_reduced = [&](size_t stop, bool block) {
+            if (batch_size == 0) {
+                if (!block && !group->done(totals_ticket)) {
+                    return;
+                }
+                group->wait(totals_ticket);
+                batch_size = static_cast<size_t>(totals[0]);
+            }
+            for (; next > stop && (block || group->done(tickets[next - 1])); --next) {
+                group->wait(tickets[next - 1]);
+                const auto [offset, count] = exec_params[next - 1];
+                queue_update(updates, offset, count, SparseRows{}, update_slice, no_rows);
+            }
+        };
+        TensorView g{grad_y.data().data(), batch_rows, cols.back()};
+        for (std::size_t i = exec.size(); i-- > 0; ) {
+            backward_layer(i, g);
+            const auto [offset, count] = exec_params[i];
+            if (count != 0) {
+                tickets[i] = last_ticket = group->all_reduce_async(grads + offset, count);
+            }
+            queue_reduced(i + 1, false);
+        }
+        queue_reduced(0, true);
+        updates.wait();
+        params_changed();
+        return totals[1];
     }
 
     void Sequential::step(size_t batch_size) {
         if (!optim_cfg) {
             throw std::runtime_error("Optimizer not set");
         }
+        ensure_arena();
+        // Every parameter gets the same elementwise update, so the whole model
+        // is one parallel pass over the arena.
+        ++step_t;
+        float* g = arena->region(ParamArena::Grads);
+        auto update_slice = [&](size_t i0, size_t i1) { update(g, i0, i1, batch_size); };
+        const SparseRows sparse = exec.empty() ? SparseRows{} : exec[0]->touched_rows();
+        auto update_sparse = [&](size_t r0, size_t r1) {
+            update_rows(g, exec_params[0].first, sparse.rows.subspan(r0, r1 - r0), sparse.row_floats, batch_size);
+        };
+        if ((runtime::profiling || sparse.row_floats != 0) && !exec_params.empty()) {
+            // Layer by layer, so each chunk's time belongs to one layer and a sparse
+            // first layer only updates the rows it touched
+            runtime::TaskGroup updates;
+            for (size_t i = 0; i < exec_params.size(); ++i) {
+                const auto [offset, count] = exec_params[i];
+                queue_update(updates, offset, count, i == 0 ? sparse : SparseRows{}, update_slice, update_sparse);
+            }
+            updates.wait();
+        } else {
+            parallel_chunks(arena->size(), elementwise_grain, update_slice);
+        }
+        params_changed();
+    }
+
+    // Optimizer update of arena[i0, i1) from gradients g (arena layout), which are zeroed.
+    void Sequential::update(float* g, size_t i0, size_t i1, size_t batch_size) {
+        const uint32_t whole = 0;
+        update_rows(g, i0, {&whole, 1}, i1 - i0, batch_size);
+    }
+
+    // The same for rows (sorted) of row_floats floats each, counted from arena offset base.
+    // Rows left out keep their moments as they are: a lazy update for sparse gradients.
+    void Sequential::update_rows(float* g, size_t base, std::span<const uint32_t> rows, size_t row_floats, size_t batch_size) {
+        // Attributed to the exec entry holding the rows, or to "model" when they span several
+        auto slot = [&] {
+            const size_t i0 = base + size_t{rows.front()} * row_floats;
+            const size_t i1 = base + (size_t{rows.back()} + 1) * row_floats;
+            const auto it = std::ranges::upper_bound(exec_params, i0, {}, &std::pair<size_t, size_t>::first);
+            if (it == exec_params.begin()) {
+                return exec.size();
+            }
+            const auto [offset, count] = *std::prev(it);
+            return i1 <= offset + count ? static_cast<size_t>(it - exec_params.begin() - 1) : exec.size();
+        };
+        Probe probe(*profiler, runtime::Phase::Step, runtime::profiling ? slot() : 0,
+                    [&] { return step_cost(*optim_cfg, rows.size() * row_floats); });
+        const auto& k = simd::kernels();
+        const size_t n = row_floats;
+        const float scale = 1.0f / static_cast<float>(batch_size);
+        // fn(w, g, m1, m2) at the start of every row
+        auto for_rows = [&](auto&& fn) {
+            for (const uint32_t r : rows) {
+                const size_t i = base + size_t{r} * row_floats;
+                fn(arena->region(ParamArena::Params) + i, g + i,
+                   arena->region(ParamArena::Moment1) + i, arena->region(ParamArena::Moment2) + i);
+            }
+        };
+
         std::visit([&](auto& opt){
             using Opt = std::decay_t<decltype(opt)>;
             if constexpr (std::is_same_v<Opt, SGD>) {
-                for (auto& l : layers) {
-                        l->step_SGD(opt.lr, batch_size);
-                    }
+                for_rows([&](float* w, float* g, float*, float*) { k.step_SGD(w, g, n, opt.lr * scale); });
             } else if constexpr (std::is_same_v<Opt, RMSProp>) {
-                    for (auto& l : layers) {
-                        l->step_RMSProp(opt.lr, opt.alpha, opt.eps, batch_size);
-                    }
+                for_rows([&](float* w, float* g, float*, float* m2) {
+                    k.step_RMSProp(w, g, m2, n, opt.lr * scale, opt.alpha, opt.eps);
+                });
             } else if constexpr(std::is_same_v<Opt, Momentum>) {
-                    for (auto& l : layers) {
-                         l->step_momentum(opt.lr, opt.mu, batch_size);
-                    }
+                for_rows([&](float* w, float* g, float* m1, float*) { k.step_momentum(w, g, m1, n, opt.lr * scale, opt.mu); });
             }
                 
             else if constexpr (std::is_same_v<Opt, Adam>) {
-                ++step_t;
                 const float bc1 = 1.0f - std::pow(opt.beta1, static_cast<float>(step_t));
                 const float bc2 = 1.0f - std::pow(opt.beta2, static_cast<float>(step_t));
-
-                for (auto& l : layers) {
-                    l->step_Adam(opt.lr, opt.beta1, opt.beta2, opt.eps,
-                                bc1, bc2, batch_size);
-                }
+                for_rows([&](float* w, float* g, float* m1, float* m2) {
+                    k.step_Adam(w, g, m1, m2, n, opt.beta1, opt.beta2, opt.lr * scale / bc1, 1.0f / bc2, opt.eps);
+                });
             }
         }, *optim_cfg);
-
     }
 
-    TensorView Sequential::compute_grad_loss(const TensorView& a, const TensorView& b) { // Gradient of loss w.r.t output
-        // Input tensor size: batch_size x feature_dim
-        size_t a_rows = a.rows, a_cols = a.cols;
-        size_t a_size = a.rows * a.cols;
-        std::vector<float> out(a_size);
-        switch (loss_cfg.l) {
-            case LossType::MSE:
-                for (size_t i = 0; i < a_size; i++) {
-                    out[i] = a.data[i] - b.data[i];
-                }
-                break;
-            case LossType::CrossEntropy: {
-                for (size_t i = 0; i < a_rows; ++i) {
-                    const size_t row = i * a_cols;
-
-                    float m = a.data[row];
-                    for (size_t j = 1; j < a_cols; ++j) {
-                        m = std::max(m, a.data[row + j]);
-                    }
-                    float sum = 0.0f;
-                    for (size_t j = 0; j < a_cols; ++j) {
-                        float e = std::exp(a.data[row + j] - m);
-                        out[row + j] = e; 
-                        sum += e;
-                    }
-                    const float inv_sum = 1.0f / sum;
-                    for (size_t j = 0; j < a_cols; ++j) {
-                        float p = out[row + j] * inv_sum;
-                        out[row + j] = p - b.data[row + j];
-                    }
-                }
-                break;
-            }
-            case LossType::BCEWithLogits: {
-                for (size_t i = 0; i < a_size; i++) {
-                    // Sigmoid activation
-                    float z = a.data[i];
-                    float y;
-                    if (z >= 0.0f) {
-                        float ez = std::exp(-z);
-                        y = 1.0f / (1.0f + ez);
-                    } else {
-                        float ez = std::exp(z);
-                        y = ez / (1.0f + ez);
-                    }
-                    out[i] = y - b.data[i];
-                }
+    void Sequential::set_data_parallel(size_t workers, bool lock_free) {
+        if (workers == 0) {
+            workers = runtime::num_threads();
+        }
+        ensure_arena();
+        hogwild = lock_free;
+        replicas.clear();
+        if (workers < 2) {
+            return;
+        }
+        shard_loss.assign(workers, 0.0f);
+        for (size_t i = 0; i < workers; ++i) {
+            auto r = std::make_unique<Sequential>();
+            r->arena = std::make_unique<ParamArena>(ParamArena::replica(*arena));
+            size_t offset = 0;
+            for (auto& l : layers) {
+                r->layers.push_back(l->replicate(*r->arena, offset));
+                offset += l->param_count();
             }
+            r->loss_cfg = loss_cfg;
+            r->fusion = fusion;
+            r->profiler = profiler;
+            r->set_precision(precision);
+            replicas.push_back(std::move(r));
         }
-        bbuf = Tensor(std::move(out), a.rows, a.cols);
-        return TensorView(bbuf);
     }
 
-    void Sequential::save(const std::string &path) const {
-        auto [data, out] = zpp::bits::data_out();
-        std::size_t n = layers.size();
-        out(n).or_throw();
-        
-        for (const auto &ptr : layers) {
-            save_layer(out, *ptr);
+    void Sequential::set_process_group(std::shared_ptr<runtime::ProcessGroup> g) {
+        ensure_arena();
+        group = std::move(g);
+        if (!group) {
+            return;
+        }
+        for (const auto region : {ParamArena::Params, ParamArena::Moment1, ParamArena::Moment2}) {
+            group->broadcast(arena->region(region), arena->size());
+        }
+        float t = static_cast<float>(step_t);
+        group->broadcast(&t, 1);
+        step_t = static_cast<size_t>(t);
+        params_changed();
+    }
+
+    float Sequential::train_step(const TensorView& x, const TensorView& t) {
+        if (replicas.empty()) {
+            const float loss = compute_loss_and_grad(pred(x), t);
+            if (group) {
+                return backward_and_step_group(x.rows, loss);
+            }
+            backward_and_step(x.rows);
+            return loss;
+        }
+        if (!optim_cfg) {
+            throw std::runtime_error("Optimizer not set");
+        }
+        if (group && hogwild) {
+            throw std::logic_error("Sequential::train_step: hogwild replicas cannot train in a process group");
+        }
+        if constexpr (runtime::profiling) {
+            plan_cols(x.cols); // Only the replicas run the layers; step() needs the plan's layout
+        }
+        const size_t shards = std::min(replicas.size(), x.rows);
+        const size_t shard_rows = (x.rows + shards - 1) / shards;
+        const size_t n = arena->size();
+        if (hogwild) {
+            ++step_t;
         }
 
-        std::ofstream file(path, std::ios::binary);
-        if (!file) {
-            throw std::runtime_error("Sequential::save: failed to open " + path);
+        // Layer GEMMs inside a worker queue their tiles on the same pool.
+        runtime::parallel_for(shards, 1, [&](size_t w, size_t) {
+            const size_t r0 = std::min(x.rows, w * shard_rows);
+            const size_t r1 = std::min(x.rows, r0 + shard_rows);
+            shard_loss[w] = 0.0f;
+            if (r0 == r1) {
+                return;
+            }
+            Sequential& r = *replicas[w];
+            const TensorView xs = x.slice_rows(r0, r1);
+            const TensorView ts = t.slice_rows(r0, r1);
+            shard_loss[w] = r.compute_loss_and_grad(r.pred(xs), ts);
+            r.backward();
+            if (hogwild) {
+                // Lock-free: races with the other workers on the shared weights and moments.
+                update(r.arena->region(ParamArena::Grads), 0, n, r1 - r0);
+            }
+        });
+        if (hogwild) {
+            params_changed();
+        } else {
+            // Reduce-scatter: each task sums one slice of every replica's gradients.
+            const auto& k = simd::kernels();
+            float* grads = arena->region(ParamArena::Grads);
+            const size_t chunk = align_floats((n + shards - 1) / shards);
+            runtime::parallel_for(shards, 1, [&](size_t c, size_t) {
+                const size_t i0 = std::min(n, c * chunk);
+                const size_t i1 = std::min(n, i0 + chunk);
+                for (size_t w = 0; w < shards; ++w) {
+                    k.accumulate(grads + i0, replicas[w]->arena->region(ParamArena::Grads) + i0, i1 - i0);
+                }
+            });
         }
 
-        file.write(reinterpret_cast<const char*>(data.data()),
-                static_cast<std::streamsize>(data.size()));
-        if (!file) {
-            throw std::runtime_error("Sequential::save: failed to write " + path);
+        float loss = 0.0f;
+        for (size_t w = 0; w < shards; ++w) {
+            loss += shard_loss[w];
+        }
+        if (group) {
+            // The replicas are done, so the whole arena goes to the other ranks at once
+            std::array<float, 2> totals{static_cast<float>(x.rows), loss};
+            group->all_reduce(totals.data(), totals.size());
+            group->all_reduce(arena->region(ParamArena::Grads), n);
+            step(static_cast<size_t>(totals[0]));
+            return totals[1];
+        }
+        if (!hogwild) {
+            step(x.rows);
         }
+        return loss;
     }
 
+    float Sequential::train_step(const SparseView& x, const TensorView& t) {
+        return train_first(x, t);
+    }
 
-    Sequential Sequential::load(const std::string &path) {
-        std::ifstream file(path, std::ios::binary | std::ios::ate);
-        if (!file) {
-            throw std::runtime_error("Sequential::load: failed to open " + path);
+    float Sequential::train_step(const IndexView& x, const TensorView& t) {
+        return train_first(x, t);
+    }
+
+    template <class Input>
+    float Sequential::train_first(const Input& x, const TensorView& t) {
+        if (!replicas.empty() || group) {
+            throw std::logic_error("Sequential::train_step: sparse batches do not support data-parallel training");
         }
+        const float loss = compute_loss_and_grad(pred(x), t);
+        backward_and_step(x.rows);
+        return loss;
+    }
 
-        std::streampos end = file.tellg();
-        if (end < 0) {
-            throw std::runtime_error("Sequential::load: tellg() failed for " + path);
+    float Sequential::compute_loss_and_grad(const TensorView& a, const TensorView& b) { // Loss, and its gradient w.r.t output into grad_y
+        // Input tensor size: batch_size x feature_dim
+        size_t a_size = a.rows * a.cols;
+        if (grad_y.data().size() < a_size) {
+            grad_y = Tensor(a.rows, a.cols);
         }
+        if (loss_partial.size() < loss_chunks(a.rows, a.cols)) {
+            loss_partial.resize(loss_chunks(a.rows, a.cols));
+        }
+        Probe probe(*profiler, runtime::Phase::Loss, exec.size(), [&] {
+            const double n = static_cast<double>(a_size);
+            return LayerCost{4.0 * n, 12.0 * n};
+        });
+        return loss_and_grad(loss_cfg.l, a, b, TensorView(grad_y.data().data(), a.rows, a.cols), loss_partial.data());
+    }
 
-        size_t size = static_cast<size_t>(end);
-        file.seekg(0, std::ios::beg);
+    TensorView Sequential::compute_grad_loss(const TensorView& a, const TensorView& b) { // Gradient of loss w.r.t output
+        compute_loss_and_grad(a, b);
+        return TensorView(grad_y.data().data(), a.rows, a.cols);
+    }
 
-        std::vector<std::byte> data(size);
-        if (!file.read(reinterpret_cast<char*>(data.data()),
-                    static_cast<std::streamsize>(size))) {
-            throw std::runtime_error("Sequential::load: failed to read " + path);
+    void Sequential::save(const std::string &path) const {
+        ModelFileHeader header;
+        header.num_layers = static_cast<uint32_t>(layers.size());
+        std::vector<LayerRecord> records(layers.size());
+        auto [shapes, out] = zpp::bits::data_out();
+        size_t offset = 0;
+        for (size_t i = 0; i < layers.size(); ++i) {
+            LayerRecord& rec = records[i];
+            rec.kind = layers[i]->kind();
+            rec.shape_offset = out.position();
+            layers[i]->save_shape(out);
+            rec.shape_size = out.position() - rec.shape_offset;
+            rec.param_offset = offset;
+            rec.param_count = layers[i]->param_count();
+            if (rec.param_count != 0 && layers[i]->param_data() == nullptr) {
+                throw std::logic_error("Sequential::save: layer has parameters but no param_data()");
+            }
+            offset += rec.param_count;
         }
+        header.shapes_offset = sizeof(ModelFileHeader) + records.size() * sizeof(LayerRecord);
+        header.shapes_size = out.position();
+        const size_t shapes_end = header.shapes_offset + header.shapes_size;
+        header.params_offset = (shapes_end + tensor_alignment - 1) / tensor_alignment * tensor_alignment;
+        header.params_floats = offset;
+
+        // Written aside and renamed: a loaded model may still map the file at path, which
+        // keeps its old contents until the mapping goes
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("Sequential::save: failed to open " + tmp);
+            }
+            const char padding[tensor_alignment] = {};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(records.data()),
+                    static_cast<std::streamsize>(records.size() * sizeof(LayerRecord)));
+            file.write(reinterpret_cast<const char*>(shapes.data()), static_cast<std::streamsize>(header.shapes_size));
+            file.write(padding, static_cast<std::streamsize>(header.params_offset - shapes_end));
+            for (const auto& l : layers) {
+                file.write(reinterpret_cast<const char*>(l->param_data()),
+                        static_cast<std::streamsize>(l->param_count() * sizeof(float)));
+            }
+            file.close();
+            if (!file) {
+                std::error_code ignored;
+                std::filesystem::remove(tmp, ignored);
+                throw std::runtime_error("Sequential::save: failed to write " + path);
+            }
+        }
+        std::filesystem::rename(tmp, path);
+    }
+
+    Sequential Sequential::load(const std::string &path) {
+        const ModelFileReader file(path, "Sequential::load");
+        if (file.is_stream()) {
+            const auto bytes = file.bytes();
+            return load_stream(std::vector<std::byte>(bytes.begin(), bytes.end()));
+        }
+
+        Sequential seq;
+        seq.arena = std::make_unique<ParamArena>(ParamArena::external(file.params(), file.params_floats(), file.mapped()));
+        seq.layers.reserve(file.num_layers());
+        size_t offset = 0;
+        for (size_t i = 0; i < file.num_layers(); ++i) {
+            const LayerRecord& rec = file.record(i);
+            std::vector<std::byte> data = file.shape(i);
+            zpp::bits::in in(data);
+            seq.layers.emplace_back(load_layer(rec.kind, in, *seq.arena, offset));
+            if (seq.layers.back()->param_count() != rec.param_count) {
+                throw std::runtime_error("Sequential::load: parameter count mismatch in " + path);
+            }
+            offset += rec.param_count;
+        }
+        return seq;
+    }
 
+    // Models saved before the mapped format: one zpp_bits stream, weights inline.
+    Sequential Sequential::load_stream(std::vector<std::byte> data) {
         zpp::bits::in in(data);
 
         size_t n{};
@@ -195,4 +914,4 @@ namespace wolf {
         return seq;
     }
 
-}
\ No newline at end of file
+}
@@ -1,14 +1,35 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <array>
+#include <span>
+#include <utility>
 #include <model/Layer.h>
+#include <model/ParamArena.h>
 #include <model/optimizers.h>
 #include <model/Loss.h>
 
+namespace wolf::runtime {
+class ProcessGroup;
+}
+
 namespace wolf {
 
 class Sequential {
 public:
+    // Disables activation caching for its lifetime:
+    //     auto no_grad = model.inference_mode();
+    class InferenceGuard {
+    public:
+        explicit InferenceGuard(Sequential& m) : model(m), prev(m.grad_enabled) { model.set_grad_enabled(false); }
+        ~InferenceGuard() { model.set_grad_enabled(prev); }
+        InferenceGuard(const InferenceGuard&) = delete;
+        InferenceGuard& operator=(const InferenceGuard&) = delete;
+    private:
+        Sequential& model;
+        bool prev;
+    };
+
     Sequential() = default;
 
     template<typename... LayerPtrs>
@@ -17,26 +38,132 @@ public:
     }
     void set_optimizer(OptimVariant cfg);
     Tensor pred(const Tensor &x);
+    // Runs on buffers planned by init(); x must stay valid until backward().
     TensorView pred(TensorView x);
+    // pred() without keeping anything for backward; needs only two activation buffers.
+    TensorView pred_inference(TensorView x);
+    // Reentrant inference: the model is only read, so any number of threads may call this
+    // at once, each with its own ctx. The result lives in ctx until its next use.
+    TensorView pred(TensorView x, InferenceContext& ctx) const;
+    // Sparse input (a CSR batch, math/sparse.h) for a model whose first layer is a SparseLinear.
+    // x must stay valid until backward(), which then returns an empty input gradient.
+    TensorView pred(const SparseView& x);
+    TensorView pred_inference(const SparseView& x);
+    // Index input ([B x fields] ids) for a model whose first layer is an Embedding, likewise.
+    TensorView pred(const IndexView& x);
+    TensorView pred_inference(const IndexView& x);
     Tensor backward(const Tensor& grad_y);
     TensorView backward();
+    void set_grad_enabled(bool on);
+    // Run adjacent Linear -> ReLU pairs as one fused layer (on by default).
+    void set_fusion(bool on);
+    // BF16 stores weights and cached activations of Linear layers as bfloat16 with fp32
+    // master weights; optimizers, save and load are unchanged.
+    void set_precision(Precision p);
+    // Post-training int8 quantization for inference: every Linear (with the ReLU after it,
+    // if any) becomes a QuantizedLinear. The model can no longer be trained.
+    void quantize();
+    [[nodiscard]] InferenceGuard inference_mode() { return InferenceGuard(*this); }
     void set_GPU(bool){};
-    void init();
+    // Plans every activation and gradient buffer for batches of up to max_batch rows.
+    // pred() calls this itself when a batch does not fit the current plan.
+    // With sparse_input the first layer reads a SparseView or IndexView, which has no
+    // gradient: nothing of the (possibly huge) input width is planned.
+    void init(size_t max_batch, size_t in_cols, bool sparse_input = false);
+    void init_inference(size_t max_batch, size_t in_cols);
     void step(float lr, size_t batch_size = 1);
     void step(size_t batch_size = 1);
-    void set_loss(LossType a) {loss_cfg.l = a;}
+    void set_loss(LossType a) {
+        loss_cfg.l = a;
+        for (auto& r : replicas) {
+            r->set_loss(a);
+        }
+    }
     TensorView compute_grad_loss(const TensorView& a, const TensorView& b);
+    // Like compute_grad_loss, but also returns the batch loss from the same pass.
+    float compute_loss_and_grad(const TensorView& a, const TensorView& b);
+    // Data-parallel training: train_step() splits each batch over `workers` replicas
+    // (0 = one per pool thread, 1 = off) that share this model's weights but keep their
+    // own activations and gradients. Their gradients are reduce-scattered into this model
+    // before one step. With hogwild each replica instead steps the shared weights itself,
+    // without locks, as soon as its backward finishes (faster, not reproducible).
+    void set_data_parallel(size_t workers, bool hogwild = false);
+    // Multi-process data-parallel training (runtime/ProcessGroup.h): this process is one
+    // rank and train_step() takes its shard of the global batch. Each layer's gradients are
+    // summed over the ranks while the layers below still backpropagate, and every rank
+    // takes the same step with the global batch size, so the replicas stay identical.
+    // Rank 0's parameters are copied to the others here: call it once the model is built
+    // (before training) on every rank. Combines with set_data_parallel, but not hogwild.
+    void set_process_group(std::shared_ptr<runtime::ProcessGroup> group);
+    // pred, loss, backward and step on one batch; returns the summed batch loss
+    // (over every rank's shard in a process group).
+    float train_step(const TensorView& x, const TensorView& t);
+    // Only updates the first-layer rows of the batch's active features (see SparseRows).
+    // Not supported with data-parallel replicas or a process group.
+    float train_step(const SparseView& x, const TensorView& t);
+    // Only updates the embedding rows of the batch's ids; same restriction.
+    float train_step(const IndexView& x, const TensorView& t);
+    // Writes the mapped model format (model/ModelFile.h).
     void save(const std::string &path) const;
+    // Maps the file and views the parameters in place; gradients and optimizer state
+    // are only allocated if the model trains. Older zpp_bits files are still read.
     static Sequential load(const std::string &path);
+    // Time, FLOPs, bytes and pool wait of every forward, backward, loss and optimizer pass,
+    // per layer of the execution plan; the last slot ("model") holds the loss and updates
+    // that span layers. Only recorded in WOLF_PROFILE builds.
+    //     model.profile().write_chrome_trace("trace.json");
+    const runtime::Profiler& profile() const { return *profiler; }
+    void reset_profile() { profiler->clear(); }
 
 private:
+    static Sequential load_stream(std::vector<std::byte> data);
+    void bind_arena();
+    void ensure_arena();
+    void update(float* grads, size_t i0, size_t i1, size_t batch_size);
+    void update_rows(float* grads, size_t base, std::span<const uint32_t> rows, size_t row_floats, size_t batch_size);
+    TensorView forward_from(size_t first, TensorView cur);
+    TensorView infer_from(size_t first, TensorView cur);
+    template <class Input> TensorView pred_first(const Input& x);
+    template <class Input> TensorView infer_first(const Input& x);
+    template <class Input> float train_first(const Input& x, const TensorView& t);
+    void backward_layer(size_t i, TensorView& g);
+    void backward_and_step(size_t batch_size);
+    float backward_and_step_group(size_t rows, float loss);
+    void params_changed();
+    void fuse_layers();
+    void plan_cols(size_t in_cols);
+    size_t widest_output() const;
+    void describe_profile();
+
     std::vector<std::unique_ptr<Layer>> layers;
-    Tensor fbuf; // Forward Buffer
-    Tensor bbuf; // Backward buffer
+    std::unique_ptr<ParamArena> arena; // Every layer's parameters, see bind_arena()
+    std::vector<std::unique_ptr<Sequential>> replicas; // Data-parallel workers
+    std::vector<float> shard_loss; // Per replica, summed in order for a reproducible loss
+    bool hogwild = false;
+    std::shared_ptr<runtime::ProcessGroup> group; // Other processes training this model
+    std::vector<Layer*> exec; // Execution plan over layers, built by fuse_layers()
+    std::vector<std::pair<size_t, size_t>> exec_params; // Arena offset and floats of each exec entry
+    std::vector<std::unique_ptr<Layer>> fused; // Fused layers referenced by exec
+    bool fusion = true;
+    Precision precision = Precision::FP32;
+    std::vector<size_t> cols; // cols[i] is the input width of exec[i], cols.back() the output width
+    std::vector<Tensor> acts; // Outputs kept for backward (empty where shared_acts is used)
+    std::array<Tensor, 2> shared_acts; // Outputs no later layer keeps a view of
+    std::array<Tensor, 2> fbuf; // Forward ping-pong buffers for inference
+    std::array<Tensor, 2> bbuf; // Backward ping-pong buffers
     Tensor grad_y; // dE_dy
+    std::vector<float> loss_partial; // Per-chunk sums of loss_and_grad
+    size_t plan_rows = 0;
+    bool plan_sparse = false; // The plan was made for sparse or index input
+    size_t infer_rows = 0;
+    bool grad_enabled = true;
+    size_t batch_rows = 0; // Rows of the last pred
+    bool sparse_in = false; // Last pred took sparse or index input
+    size_t sparse_nnz = 0;  // Its non-zeros or ids
     std::optional<OptimVariant> optim_cfg;
     size_t step_t = 0;
     LossConfig loss_cfg;
+    std::shared_ptr<runtime::Profiler> profiler = std::make_shared<runtime::Profiler>(); // Shared with replicas
 };
 
 }
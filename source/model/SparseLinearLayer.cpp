@@ -0,0 +1,162 @@
+#include <model/SparseLinearLayer.h>
+#include <math/rng.h>
+#include <math/gemm.h>
+#include <math/simd/simd.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace wolf {
+    namespace {
+        // Batch rows per forward task
+        constexpr size_t row_grain = 16;
+    }
+
+    SparseLinearLayer::SparseLinearLayer(size_t x_dim, size_t y_dim) : ArenaLayer(LayerKind::SparseLinear), x_dim(x_dim),
+            y_dim(y_dim) {
+        own_slot();
+
+        auto& gen = rng().gen;
+        auto normal_gen = [&]() {return std::normal_distribution<float>{0.0f, std::sqrt(2.0f / x_dim)}(gen);};
+        std::generate_n(Wt.data, Wt.size(), normal_gen);
+        std::generate_n(b.data, b.size(), normal_gen);
+    }
+
+    SparseLinearLayer::SparseLinearLayer(size_t x_dim, size_t y_dim, ParamArena& arena, size_t offset)
+            : ArenaLayer(LayerKind::SparseLinear), x_dim(x_dim), y_dim(y_dim) {
+        view_params(arena, offset);
+    }
+
+    void SparseLinearLayer::view_params(ParamArena& target, size_t offset) {
+        arena = &target;
+        arena_offset = offset;
+        const size_t b_offset = offset + align_floats(x_dim * y_dim);
+        Wt  = target.view(ParamArena::Params,  offset, x_dim, y_dim);
+        dWt = target.view(ParamArena::Grads,   offset, x_dim, y_dim);
+        b   = target.view(ParamArena::Params,  b_offset, 1, y_dim);
+        db  = target.view(ParamArena::Grads,   b_offset, 1, y_dim);
+    }
+
+    void SparseLinearLayer::forward_into(const TensorView& x, TensorView out) {
+        last_input = grad_enabled ? x : TensorView{};
+        last_sparse = SparseView{};
+        run_dense(x, out);
+    }
+
+    void SparseLinearLayer::infer(const TensorView& x, TensorView out, InferenceContext&) const {
+        run_dense(x, out);
+    }
+
+    void SparseLinearLayer::run_dense(const TensorView& x, TensorView out) const {
+        // out = x * Wt + b
+        const GemmOperand xa = gemm_operand(x);
+        gemm(xa.trans, Trans::No, x.rows, y_dim, x_dim,
+             xa.data, xa.ld,
+             Wt.data, y_dim,
+             0.0f, out.data, out.stride,
+             GemmEpilogue{.bias = b.data});
+    }
+
+    void SparseLinearLayer::backward_into(const TensorView& grad_out, TensorView grad_in) {
+        const size_t batch_size = grad_out.rows;
+        // dWt += x^T * grad_out
+        const GemmOperand xt = gemm_operand(last_input, Trans::Yes);
+        const GemmOperand g = gemm_operand(grad_out);
+        gemm(xt.trans, g.trans, x_dim, y_dim, batch_size,
+             xt.data, xt.ld,
+             g.data, g.ld,
+             1.0f, dWt.data, y_dim);
+        for (size_t r = 0; r < batch_size; ++r) {
+            for (size_t y = 0; y < y_dim; ++y) {
+                db(y) += grad_out(r, y);
+            }
+        }
+        // grad_in = grad_out * Wt^T
+        gemm(g.trans, Trans::Yes, batch_size, x_dim, y_dim,
+             g.data, g.ld,
+             Wt.data, y_dim,
+             0.0f, grad_in.data, grad_in.stride);
+        dense_grad = true;
+    }
+
+    // Sparse x dense: each output row is the bias plus the weight rows of its features.
+    void SparseLinearLayer::run_sparse(const SparseView& x, TensorView out) const {
+        if (x.cols != x_dim) {
+            throw std::runtime_error("SparseLinearLayer: input has " + std::to_string(x.cols)
+                                     + " columns, expected " + std::to_string(x_dim));
+        }
+        // Before any task writes out, and out of the inner loop
+        const uint32_t* first = x.rows == 0 ? nullptr : x.col_idx + x.row_ptr[0];
+        const uint32_t* last = first + x.nnz();
+        if (std::any_of(first, last, [&](uint32_t c) { return c >= x_dim; })) {
+            throw std::runtime_error("SparseLinearLayer: column index out of range");
+        }
+        runtime::parallel_for(x.rows, row_grain, [&](size_t r0, size_t r1) {
+            for (size_t r = r0; r < r1; ++r) {
+                float* o = out.row(r);
+                std::copy_n(b.data, y_dim, o);
+                for (size_t i = x.row_ptr[r]; i < x.row_ptr[r + 1]; ++i) {
+                    const float v = x.values[i];
+                    const float* w = Wt.data + size_t{x.col_idx[i]} * y_dim;
+                    for (size_t j = 0; j < y_dim; ++j) {
+                        o[j] += v * w[j];
+                    }
+                }
+            }
+        });
+    }
+
+    void SparseLinearLayer::forward_sparse(const SparseView& x, TensorView out) {
+        run_sparse(x, out);
+        last_input = TensorView{};
+        last_sparse = grad_enabled ? x : SparseView{};
+    }
+
+    // dWt[k] += v * grad_out[r] for every non-zero (r, k, v): only the rows of active features.
+    void SparseLinearLayer::backward_sparse(const TensorView& grad_out) {
+        const SparseView& x = last_sparse;
+        const TensorView g = row_major(grad_out, grad_rows);
+        for (size_t r = 0; r < x.rows; ++r) {
+            for (size_t y = 0; y < y_dim; ++y) {
+                db(y) += g(r, y);
+            }
+            for (size_t i = x.row_ptr[r]; i < x.row_ptr[r + 1]; ++i) {
+                sparse_dW.add(x.col_idx[i], g.row(r), x.values[i]);
+            }
+        }
+        sparse_dW.accumulate(dWt.data, y_dim);
+        sparse_grad = true;
+    }
+
+    SparseRows SparseLinearLayer::touched_rows() const {
+        if (!sparse_grad || dense_grad) {
+            return {};
+        }
+        return {sparse_dW.touched(), y_dim, align_floats(x_dim * y_dim)};
+    }
+
+    void SparseLinearLayer::params_changed() {
+        sparse_dW.clear_touched();
+        sparse_grad = false;
+        dense_grad = false;
+    }
+
+    LayerCost SparseLinearLayer::cost(runtime::Phase phase, size_t rows, size_t) const {
+        const double r = static_cast<double>(rows);
+        const double xy = static_cast<double>(x_dim * y_dim);
+        if (phase == runtime::Phase::Forward) {
+            return {2.0 * r * xy + r * y_dim, 4.0 * (xy + y_dim + r * (x_dim + y_dim))};
+        }
+        return {4.0 * r * xy + r * y_dim, 12.0 * xy + 8.0 * y_dim + 4.0 * r * (2.0 * x_dim + y_dim)};
+    }
+
+    // Each non-zero reads one weight row; backward also reads a grad_out row and updates a dWt row.
+    LayerCost SparseLinearLayer::sparse_cost(runtime::Phase phase, size_t rows, size_t nnz) const {
+        const double n = static_cast<double>(nnz);
+        const double r = static_cast<double>(rows);
+        if (phase == runtime::Phase::Forward) {
+            return {2.0 * n * y_dim, n * (4.0 * y_dim + 8.0) + 4.0 * (r + 1.0) * y_dim};
+        }
+        return {2.0 * n * y_dim + r * y_dim, n * (12.0 * y_dim + 8.0) + 4.0 * r * y_dim + 8.0 * y_dim};
+    }
+}
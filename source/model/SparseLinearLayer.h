@@ -0,0 +1,87 @@
+#pragma once
+#include <math/tensor.h>
+#include <math/sparse.h>
+#include <math/parallel.h>
+#include <model/ArenaLayer.h>
+#include <model/RowSparseGrad.h>
+#include <external/zpp_bits.h>
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+
+namespace wolf {
+
+// y = Wx + b for very wide, mostly zero inputs (hashed bag-of-words and the like).
+// W is stored transposed, one contiguous row of out_dim weights per input feature, so a
+// sparse batch only reads, accumulates into and updates the rows of its active features.
+// Dense input works too, through the same GEMM as LinearLayer.
+class SparseLinearLayer : public ArenaLayer {
+public:
+    SparseLinearLayer(size_t x_dim, size_t y_dim);
+    SparseLinearLayer(size_t x_dim, size_t y_dim, ParamArena& arena, size_t offset);
+
+    size_t out_cols(size_t) const override { return y_dim; }
+    void forward_into(const TensorView& x, TensorView out) override;
+    void infer(const TensorView& x, TensorView out, InferenceContext&) const override;
+    void backward_into(const TensorView& grad_out, TensorView grad_in) override;
+    void forward_sparse(const SparseView& x, TensorView out) override;
+    void backward_sparse(const TensorView& grad_out) override;
+    SparseRows touched_rows() const override;
+    void params_changed() override;
+
+    LayerCost cost(runtime::Phase phase, size_t rows, size_t in_cols) const override;
+    LayerCost sparse_cost(runtime::Phase phase, size_t rows, size_t nnz) const override;
+    size_t in_size() const {return x_dim;}
+    size_t out_size() const {return y_dim;}
+    size_t param_count() const override { return align_floats(x_dim * y_dim) + align_floats(y_dim); }
+    std::unique_ptr<Layer> replicate(ParamArena& arena, size_t offset) const override {
+        return std::make_unique<SparseLinearLayer>(x_dim, y_dim, arena, offset);
+    }
+    void save_body(zpp::bits::out<std::vector<std::byte>>& out) const override {
+        const std::span<const float> Wv(Wt.data, Wt.size());
+        const std::span<const float> bv(b.data, b.size());
+        out(x_dim, y_dim, Wv, bv).or_throw();
+    }
+    void save_shape(zpp::bits::out<std::vector<std::byte>>& out) const override {
+        out(x_dim, y_dim).or_throw();
+    }
+    const float* param_data() const override { return Wt.data; } // b follows Wt in the slot
+    static std::unique_ptr<Layer> load_view(zpp::bits::in<std::vector<std::byte>>& in, ParamArena& arena, size_t offset) {
+        std::size_t x_dim{}, y_dim{};
+        in(x_dim, y_dim).or_throw();
+        return std::make_unique<SparseLinearLayer>(x_dim, y_dim, arena, offset);
+    }
+    static std::unique_ptr<Layer> load_from(zpp::bits::in<std::vector<std::byte>>& in) {
+        std::size_t x_dim{}, y_dim{};
+        std::vector<float> Wv, bv;
+        in(x_dim, y_dim, Wv, bv).or_throw();
+        if (Wv.size() != x_dim * y_dim || bv.size() != y_dim) {
+            throw std::runtime_error("SparseLinearLayer::load_from: weight size mismatch");
+        }
+        auto layer = std::make_unique<SparseLinearLayer>(x_dim, y_dim);
+        std::ranges::copy(Wv, layer->Wt.data);
+        std::ranges::copy(bv, layer->b.data);
+        return layer;
+    }
+
+private:
+    void view_params(ParamArena& target, size_t offset) override;
+    void run_dense(const TensorView& x, TensorView out) const;
+    void run_sparse(const SparseView& x, TensorView out) const;
+
+    size_t x_dim;
+    size_t y_dim;
+    // Views into arena
+    TensorView Wt;  // [in_dim x out_dim]
+    TensorView dWt;
+    TensorView b;   // [out_dim x 1]
+    TensorView db;
+    TensorView last_input;  // Dense: [B x in_dim], owned by the caller
+    SparseView last_sparse; // Sparse: owned by the caller
+    AlignedVector grad_rows; // A column-major grad_out gathered into rows
+    RowSparseGrad sparse_dW;
+    bool sparse_grad = false; // backward_sparse ran since the last update
+    bool dense_grad = false;  // A dense backward ran since the last update
+};
+
+}
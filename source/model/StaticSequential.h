@@ -0,0 +1,205 @@
+#pragma once
+#include <math/aligned.h>
+#include <model/Layer.h>
+#include <model/ModelFile.h>
+#include <external/zpp_bits.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Networks whose shapes are known at compile time, for small latency-critical models:
+//
+//     using Net = wolf::fixed::StaticSequential<wolf::fixed::Linear<784, 128>, wolf::fixed::ReLU,
+//                                               wolf::fixed::Linear<128, 10>>;
+//     auto net = std::make_unique<Net>(); // Weights live inside the object
+//     net->load("mnist.wolf");            // A file written by Sequential::save
+//     std::array<float, 10> y = net->pred(x);
+//
+// No virtual calls, no allocation: every loop bound is a template parameter so the
+// compiler unrolls and vectorizes each layer for its own shape, and Linear -> ReLU pairs
+// run as one loop. Inference only; pred() is const and reentrant.
+namespace wolf::fixed {
+
+template <size_t In, size_t Out>
+class Linear {
+public:
+    static_assert(In > 0 && Out > 0, "fixed::Linear needs non-zero dimensions");
+    static constexpr LayerKind kind = LayerKind::Linear;
+    static constexpr size_t in_dim = In;
+    static constexpr size_t out_dim = Out;
+    static constexpr bool accepts(size_t in) { return in == In; }
+    static constexpr size_t out_cols(size_t) { return Out; }
+    static constexpr size_t param_count() { return align_floats(Out * In) + align_floats(Out); }
+
+    // y = W x + b for one row; max(y, 0) with Relu. Wt is [In x Out], so the inner loop
+    // runs over Out contiguous outputs and needs no horizontal sum.
+    template <bool Relu>
+    void forward(const float* __restrict x, float* __restrict y) const {
+        std::array<float, Out> acc = b;
+        for (size_t i = 0; i < In; ++i) {
+            const float xi = x[i];
+            const float* w = Wt.data() + i * Out;
+            for (size_t o = 0; o < Out; ++o) {
+                acc[o] += xi * w[o];
+            }
+        }
+        for (size_t o = 0; o < Out; ++o) {
+            y[o] = Relu ? std::max(acc[o], 0.0f) : acc[o];
+        }
+    }
+
+    // params is a LinearLayer slot: W [Out x In], then b at align_floats(Out * In).
+    void load_params(const float* params) {
+        for (size_t o = 0; o < Out; ++o) {
+            for (size_t i = 0; i < In; ++i) {
+                Wt[i * Out + o] = params[o * In + i];
+            }
+        }
+        std::copy_n(params + align_floats(Out * In), Out, b.data());
+    }
+    void check_shape(zpp::bits::in<std::vector<std::byte>>& in, size_t index) const {
+        std::size_t x_dim{}, y_dim{};
+        in(x_dim, y_dim).or_throw();
+        if (x_dim != In || y_dim != Out) {
+            throw std::runtime_error("StaticSequential::load: layer " + std::to_string(index) + " is Linear<"
+                                     + std::to_string(x_dim) + ", " + std::to_string(y_dim) + "> in the file, expected Linear<"
+                                     + std::to_string(In) + ", " + std::to_string(Out) + ">");
+        }
+    }
+
+private:
+    alignas(tensor_alignment) std::array<float, In * Out> Wt{};
+    alignas(tensor_alignment) std::array<float, Out> b{};
+};
+
+class ReLU {
+public:
+    static constexpr LayerKind kind = LayerKind::ReLU;
+    static constexpr bool accepts(size_t) { return true; }
+    static constexpr size_t out_cols(size_t in) { return in; }
+    static constexpr size_t param_count() { return 0; }
+
+    template <size_t N>
+    static void forward(const float* __restrict x, float* __restrict y) {
+        for (size_t i = 0; i < N; ++i) {
+            y[i] = std::max(x[i], 0.0f);
+        }
+    }
+    void load_params(const float*) {}
+    void check_shape(zpp::bits::in<std::vector<std::byte>>&, size_t) const {}
+};
+
+template <class... Layers>
+class StaticSequential {
+    static constexpr size_t num_layers = sizeof...(Layers);
+    static_assert(num_layers > 0, "StaticSequential needs at least one layer");
+    template <size_t I>
+    using layer_t = std::tuple_element_t<I, std::tuple<Layers...>>;
+    static_assert(layer_t<0>::kind == LayerKind::Linear, "StaticSequential must start with a Linear layer");
+
+    // widths[i] is the input width of layer i, widths.back() the output width.
+    static constexpr std::array<size_t, num_layers + 1> widths = [] {
+        std::array<size_t, num_layers + 1> w{layer_t<0>::in_dim};
+        size_t i = 0;
+        ((w[i + 1] = Layers::out_cols(w[i]), ++i), ...);
+        return w;
+    }();
+    static constexpr bool shapes_match() {
+        size_t i = 0;
+        return ((Layers::accepts(widths[i++])) && ...);
+    }
+    static_assert(shapes_match(), "StaticSequential: a layer's input width differs from the previous layer's output");
+    // Widest intermediate activation
+    static constexpr size_t max_width = [] {
+        size_t m = 1;
+        for (size_t i = 1; i < num_layers; ++i) {
+            m = std::max(m, widths[i]);
+        }
+        return m;
+    }();
+    using Buffers = std::array<std::array<float, max_width>, 2>;
+
+public:
+    static constexpr size_t in_cols = widths.front();
+    static constexpr size_t out_cols = widths.back();
+
+    // One row.
+    void pred(const float* x, float* y) const {
+        alignas(tensor_alignment) Buffers bufs;
+        run<0, 0>(x, y, bufs);
+    }
+    std::array<float, out_cols> pred(const std::array<float, in_cols>& x) const {
+        std::array<float, out_cols> y;
+        pred(x.data(), y.data());
+        return y;
+    }
+    // rows x in_cols -> rows x out_cols, row-major.
+    void pred(const float* x, float* y, size_t rows) const {
+        for (size_t r = 0; r < rows; ++r) {
+            pred(x + r * in_cols, y + r * out_cols);
+        }
+    }
+
+    // Reads the weights of a model saved by Sequential::save with exactly these layers.
+    void load(const std::string& path) {
+        const ModelFileReader file(path, "StaticSequential::load");
+        if (file.is_stream()) {
+            throw std::runtime_error("StaticSequential::load: " + path + " predates the mapped model format;"
+                                     " load it with Sequential::load and save it again");
+        }
+        if (file.num_layers() != num_layers) {
+            throw std::runtime_error("StaticSequential::load: " + path + " has " + std::to_string(file.num_layers())
+                                     + " layers, expected " + std::to_string(num_layers));
+        }
+        load_layers(file, std::make_index_sequence<num_layers>{});
+    }
+
+private:
+    // Layer I reads x and writes bufs[P], or y if it is the last one.
+    template <size_t I, size_t P>
+    void run(const float* x, float* y, Buffers& bufs) const {
+        using L = layer_t<I>;
+        constexpr bool fuse = L::kind == LayerKind::Linear && I + 1 < num_layers
+                           && layer_t<std::min(I + 1, num_layers - 1)>::kind == LayerKind::ReLU;
+        constexpr size_t next = I + (fuse ? 2 : 1);
+        float* out = next == num_layers ? y : bufs[P].data();
+        if constexpr (L::kind == LayerKind::Linear) {
+            std::get<I>(layers).template forward<fuse>(x, out);
+        } else {
+            L::template forward<widths[I]>(x, out);
+        }
+        if constexpr (next < num_layers) {
+            run<next, 1 - P>(out, y, bufs);
+        }
+    }
+
+    template <size_t... I>
+    void load_layers(const ModelFileReader& file, std::index_sequence<I...>) {
+        (load_layer<I>(file), ...);
+    }
+
+    template <size_t I>
+    void load_layer(const ModelFileReader& file) {
+        using L = layer_t<I>;
+        const LayerRecord& rec = file.record(I);
+        if (rec.kind != L::kind) {
+            throw std::runtime_error("StaticSequential::load: layer " + std::to_string(I) + " has a different kind in the file");
+        }
+        std::vector<std::byte> data = file.shape(I);
+        zpp::bits::in in(data);
+        std::get<I>(layers).check_shape(in, I);
+        if (rec.param_count != L::param_count()) {
+            throw std::runtime_error("StaticSequential::load: parameter count mismatch in layer " + std::to_string(I));
+        }
+        std::get<I>(layers).load_params(file.params() + rec.param_offset);
+    }
+
+    std::tuple<Layers...> layers;
+};
+
+}
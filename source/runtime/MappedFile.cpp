@@ -0,0 +1,88 @@
+#include <runtime/MappedFile.h>
+#include <stdexcept>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace wolf::runtime {
+#if defined(_WIN32)
+    MappedFile::MappedFile(const std::string& path) {
+        // FILE_SHARE_DELETE lets the path be replaced while mapped (Sequential::save renames
+        // over it), as on POSIX; the mapping keeps the old contents
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            file = nullptr;
+            throw std::runtime_error("MappedFile: failed to open " + path);
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw std::runtime_error("MappedFile: failed to stat " + path);
+        }
+        length = static_cast<std::size_t>(size.QuadPart);
+        if (length == 0) {
+            return;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            base = static_cast<std::byte*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+        }
+        if (base == nullptr) {
+            if (mapping != nullptr) {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            throw std::runtime_error("MappedFile: failed to map " + path);
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if (base != nullptr) {
+            UnmapViewOfFile(base);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != nullptr) {
+            CloseHandle(file);
+        }
+    }
+#else
+    MappedFile::MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("MappedFile: failed to open " + path);
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("MappedFile: failed to stat " + path);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        if (length == 0) {
+            ::close(fd);
+            return;
+        }
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps the file open
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("MappedFile: failed to map " + path);
+        }
+        base = static_cast<std::byte*>(p);
+    }
+
+    MappedFile::~MappedFile() {
+        if (base != nullptr) {
+            ::munmap(base, length);
+        }
+    }
+#endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace wolf::runtime {
+
+// A whole file mapped copy-on-write: pages come straight from the page cache and
+// are shared with every other process mapping the same file until one is written,
+// at which point only that page is copied, privately. The file is never modified.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::byte* data() { return base; } // Page aligned
+    const std::byte* data() const { return base; }
+    std::size_t size() const { return length; }
+
+private:
+    std::byte* base = nullptr;
+    std::size_t length = 0;
+#if defined(_WIN32)
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+}
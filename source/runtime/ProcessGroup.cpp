@@ -0,0 +1,445 @@
+#include <runtime/ProcessGroup.h>
+#include <runtime/ThreadPool.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace wolf::runtime {
+    namespace {
+        // Floats per mailbox buffer; all_reduce moves at most this much per message.
+        constexpr std::size_t chunk_floats = std::size_t{1} << 15;
+        constexpr std::uint64_t segment_magic = 0x574f4c4650473031; // "WOLFPG01"
+        // Polls of a counter before yielding, then before sleeping between polls.
+        constexpr std::uint32_t spin_rounds = 1024;
+        constexpr std::uint32_t yield_rounds = 16384;
+        // Peers are checked for liveness every this many polls.
+        constexpr std::uint32_t check_every = 1024;
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "ProcessGroup needs lock-free 64-bit atomics");
+
+        inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+            _mm_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+
+        std::string rank_error(std::size_t r, const char* what) {
+            return "ProcessGroup: rank " + std::to_string(r) + " " + what;
+        }
+
+#if !defined(_WIN32)
+        bool process_alive(pid_t pid) {
+            if (::kill(pid, 0) != 0 && errno == ESRCH) {
+                return false;
+            }
+#if defined(__linux__)
+            // A process that exited answers kill() until its parent reaps it: state Z
+            std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+            std::string line;
+            std::getline(stat, line);
+            const std::size_t name_end = line.rfind(')');
+            if (name_end != std::string::npos && name_end + 2 < line.size() && line[name_end + 2] == 'Z') {
+                return false;
+            }
+#endif
+            return true;
+        }
+#endif
+    }
+
+    // At the start of the segment, then one RankState per rank, then two mailbox
+    // buffers of chunk_floats per rank.
+    struct alignas(64) ProcessGroup::Segment {
+        std::uint64_t world = 0;
+        std::atomic<std::uint64_t> ready{0}; // segment_magic once the creator has set it up
+        std::atomic<std::uint64_t> joined{0};
+    };
+
+    // Counters of one rank's mailbox, on their own cache lines: the owner writes posted,
+    // its right neighbour consumed.
+    struct ProcessGroup::RankState {
+        alignas(64) std::atomic<std::uint64_t> posted{0};
+        alignas(64) std::atomic<std::uint64_t> consumed{0};
+        alignas(64) std::atomic<std::int64_t> pid{0};
+        std::atomic<std::uint32_t> closed{0}; // Set when the rank leaves the group
+    };
+
+    namespace {
+        template <class Segment, class RankState>
+        std::size_t segment_bytes(std::size_t world) {
+            return sizeof(Segment) + world * sizeof(RankState) + world * 2 * chunk_floats * sizeof(float);
+        }
+    }
+
+    ProcessGroup::RankState& ProcessGroup::state(std::size_t r) const {
+        return reinterpret_cast<RankState*>(seg + 1)[r];
+    }
+
+    // Buffer of rank r that holds its message number `message`.
+    float* ProcessGroup::mailbox(std::size_t r, std::uint64_t message) const {
+        float* boxes = reinterpret_cast<float*>(&state(world_));
+        return boxes + (r * 2 + message % 2) * chunk_floats;
+    }
+
+    ProcessGroup::ProcessGroup(std::size_t rank, std::size_t world) : rank_(rank), world_(world) {
+        if (world == 0 || rank >= world) {
+            throw std::logic_error("ProcessGroup: rank " + std::to_string(rank) + " out of range for a world of "
+                                   + std::to_string(world));
+        }
+    }
+
+#if defined(_WIN32)
+    ProcessGroup::ProcessGroup(const std::string&, std::size_t rank, std::size_t world) : ProcessGroup(rank, world) {
+        throw std::runtime_error("ProcessGroup: not supported on this platform");
+    }
+
+    std::shared_ptr<ProcessGroup> ProcessGroup::spawn(std::size_t) {
+        throw std::runtime_error("ProcessGroup: not supported on this platform");
+    }
+
+    ProcessGroup::~ProcessGroup() = default;
+
+    void ProcessGroup::wait_for(const std::atomic<std::uint64_t>&, std::uint64_t, std::size_t) {}
+#else
+    ProcessGroup::ProcessGroup(const std::string& name, std::size_t rank, std::size_t world) : ProcessGroup(rank, world) {
+        seg_bytes = segment_bytes<Segment, RankState>(world);
+        int fd = -1;
+        if (rank == 0) {
+            ::shm_unlink(name.c_str()); // Left over by a run that crashed
+            fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(seg_bytes)) != 0) {
+                if (fd >= 0) {
+                    ::close(fd);
+                    ::shm_unlink(name.c_str());
+                }
+                throw std::runtime_error("ProcessGroup: failed to create shared memory " + name);
+            }
+        } else {
+            // Until rank 0 has created and sized the segment
+            for (;;) {
+                fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+                if (fd >= 0) {
+                    struct stat st{};
+                    if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) == seg_bytes) {
+                        break;
+                    }
+                    ::close(fd);
+                } else if (errno != ENOENT) {
+                    throw std::runtime_error("ProcessGroup: failed to open shared memory " + name);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        void* p = ::mmap(nullptr, seg_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            if (rank == 0) {
+                ::shm_unlink(name.c_str());
+            }
+            throw std::runtime_error("ProcessGroup: failed to map shared memory " + name);
+        }
+        seg = static_cast<Segment*>(p);
+        if (rank == 0) {
+            new (seg) Segment{};
+            seg->world = world;
+            for (std::size_t r = 0; r < world; ++r) {
+                new (&state(r)) RankState{};
+            }
+            seg->ready.store(segment_magic, std::memory_order_release);
+        } else {
+            while (seg->ready.load(std::memory_order_acquire) != segment_magic) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (seg->world != world) {
+                throw std::runtime_error("ProcessGroup: " + name + " has a world of " + std::to_string(seg->world)
+                                         + ", not " + std::to_string(world));
+            }
+        }
+        state(rank).pid.store(::getpid());
+        seg->joined.fetch_add(1, std::memory_order_acq_rel);
+        while (seg->joined.load(std::memory_order_acquire) < world) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (rank == 0) {
+            ::shm_unlink(name.c_str()); // The mappings keep it alive
+        }
+        start();
+    }
+
+    std::shared_ptr<ProcessGroup> ProcessGroup::spawn(std::size_t world) {
+        if (pool_started()) {
+            throw std::logic_error("ProcessGroup::spawn: the thread pool has already started; spawn before any parallel work");
+        }
+        if (world == 0) {
+            throw std::logic_error("ProcessGroup::spawn: a group needs at least one rank");
+        }
+        const std::size_t bytes = segment_bytes<Segment, RankState>(world);
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("ProcessGroup::spawn: failed to map shared memory");
+        }
+        auto* seg = new (p) Segment{};
+        seg->world = world;
+        auto* states = reinterpret_cast<RankState*>(seg + 1);
+        for (std::size_t r = 0; r < world; ++r) {
+            new (&states[r]) RankState{};
+        }
+        seg->ready.store(segment_magic);
+        seg->joined.store(world);
+
+        std::fflush(nullptr); // Or buffered output is written once per rank
+        std::vector<int> children;
+        std::size_t rank = 0;
+        for (std::size_t r = 1; r < world; ++r) {
+            const pid_t pid = ::fork();
+            if (pid < 0) {
+                for (const int c : children) {
+                    ::kill(c, SIGKILL);
+                    ::waitpid(c, nullptr, 0);
+                }
+                ::munmap(p, bytes);
+                throw std::runtime_error("ProcessGroup::spawn: fork failed");
+            }
+            if (pid == 0) {
+                rank = r;
+                children.clear();
+                break;
+            }
+            children.push_back(pid);
+        }
+
+#if defined(__linux__)
+        // Rank r gets the r-th of world equal shares of the allowed CPUs
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0 && CPU_COUNT(&allowed) > 0) {
+            const std::size_t n = static_cast<std::size_t>(CPU_COUNT(&allowed));
+            const std::size_t first = n >= world ? rank * n / world : rank % n;
+            const std::size_t last = n >= world ? (rank + 1) * n / world : first + 1;
+            cpu_set_t share;
+            CPU_ZERO(&share);
+            std::size_t index = 0;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    if (index >= first && index < last) {
+                        CPU_SET(cpu, &share);
+                    }
+                    ++index;
+                }
+            }
+            sched_setaffinity(0, sizeof(share), &share);
+        }
+#endif
+
+        std::shared_ptr<ProcessGroup> group(new ProcessGroup(rank, world));
+        group->seg = seg;
+        group->seg_bytes = bytes;
+        group->children = std::move(children);
+        group->state(rank).pid.store(::getpid());
+        group->start();
+        return group;
+    }
+
+    ProcessGroup::~ProcessGroup() {
+        {
+            std::lock_guard lock(m);
+            stop = true;
+        }
+        cv.notify_all();
+        if (comm.joinable()) {
+            comm.join();
+        }
+        if (seg != nullptr) {
+            state(rank_).closed.store(1, std::memory_order_release);
+            ::munmap(seg, seg_bytes);
+        }
+        for (const int pid : children) {
+            ::waitpid(pid, nullptr, 0);
+        }
+    }
+
+    // Until counter (of rank peer's state) reaches target. Throws once peer has left.
+    void ProcessGroup::wait_for(const std::atomic<std::uint64_t>& counter, std::uint64_t target, std::size_t peer) {
+        for (std::uint32_t polls = 0; counter.load(std::memory_order_acquire) < target; ++polls) {
+            if (polls < spin_rounds) {
+                cpu_relax();
+                continue;
+            }
+            if (polls < yield_rounds) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            if (polls % check_every != 0) {
+                continue;
+            }
+            // The peer may have reached target just before leaving
+            const char* gone = nullptr;
+            if (state(peer).closed.load(std::memory_order_acquire) != 0) {
+                gone = "has left the group";
+            } else if (!process_alive(static_cast<pid_t>(state(peer).pid.load()))) {
+                gone = "has exited";
+            }
+            if (gone != nullptr && counter.load(std::memory_order_acquire) < target) {
+                throw std::runtime_error(rank_error(peer, gone));
+            }
+        }
+    }
+#endif
+
+    void ProcessGroup::start() {
+        comm = std::thread([this] { run_queue(); });
+    }
+
+    // Posts src[0, n) for the right neighbour. A buffer is reused every other message,
+    // once the neighbour has consumed what it held.
+    void ProcessGroup::send(const float* src, std::size_t n) {
+        RankState& me = state(rank_);
+        if (sent >= 2) {
+            wait_for(me.consumed, sent - 1, (rank_ + 1) % world_);
+        }
+        std::copy_n(src, n, mailbox(rank_, sent));
+        me.posted.store(++sent, std::memory_order_release);
+    }
+
+    // Adds (or copies) the left neighbour's next message into dst[0, n).
+    template <bool Add>
+    void ProcessGroup::receive(float* dst, std::size_t n) {
+        const std::size_t left = (rank_ + world_ - 1) % world_;
+        RankState& from = state(left);
+        wait_for(from.posted, received + 1, left);
+        const float* src = mailbox(left, received);
+        if constexpr (Add) {
+            for (std::size_t i = 0; i < n; ++i) {
+                dst[i] += src[i];
+            }
+        } else {
+            std::copy_n(src, n, dst);
+        }
+        from.consumed.store(++received, std::memory_order_release);
+    }
+
+    // Ring all-reduce over pieces of world * chunk_floats floats, each split into world
+    // parts. Reduce-scatter: in world - 1 steps every part travels once around the ring,
+    // each rank adding its own, until rank r holds the sum of part r + 1. All-gather: the
+    // sums travel around once more and are copied. Each part is summed in the same order
+    // whoever receives it, so the ranks end up identical.
+    void ProcessGroup::ring_all_reduce(float* data, std::size_t n) {
+        const std::size_t w = world_;
+        if (w == 1) {
+            return;
+        }
+        for (std::size_t p = 0; p < n; p += w * chunk_floats) {
+            const std::size_t m = std::min(n - p, w * chunk_floats);
+            const std::size_t part = (m + w - 1) / w;
+            auto begin = [&](std::size_t j) { return data + p + std::min(m, (j % w) * part); };
+            auto size = [&](std::size_t j) { return std::min(m, (j % w) * part + part) - std::min(m, (j % w) * part); };
+            for (std::size_t s = 0; s + 1 < w; ++s) {
+                const std::size_t out = rank_ + w - s;
+                const std::size_t in = rank_ + 2 * w - s - 1;
+                send(begin(out), size(out));
+                receive<true>(begin(in), size(in));
+            }
+            for (std::size_t s = 0; s + 1 < w; ++s) {
+                const std::size_t out = rank_ + 1 + w - s;
+                const std::size_t in = rank_ + w - s;
+                send(begin(out), size(out));
+                receive<false>(begin(in), size(in));
+            }
+        }
+    }
+
+    void ProcessGroup::run_queue() {
+        for (;;) {
+            Request req{};
+            {
+                std::unique_lock lock(m);
+                cv.wait(lock, [&] { return stop || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                req = queue.front();
+            }
+            std::exception_ptr failed;
+            if (!error) { // A failed collective leaves the ring out of step: give up on the rest
+                try {
+                    ring_all_reduce(req.data, req.n);
+                } catch (...) {
+                    failed = std::current_exception();
+                    state(rank_).closed.store(1, std::memory_order_release); // So the ranks waiting on this one fail too
+                }
+            }
+            {
+                std::lock_guard lock(m);
+                queue.pop_front();
+                ++finished;
+                if (failed) {
+                    error = failed;
+                }
+            }
+            cv.notify_all();
+        }
+    }
+
+    std::uint64_t ProcessGroup::all_reduce_async(float* data, std::size_t n) {
+        std::uint64_t ticket;
+        {
+            std::lock_guard lock(m);
+            queue.push_back({data, n});
+            ticket = ++submitted;
+        }
+        cv.notify_all();
+        return ticket;
+    }
+
+    void ProcessGroup::wait(std::uint64_t ticket) {
+        std::unique_lock lock(m);
+        cv.wait(lock, [&] { return finished >= ticket; });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool ProcessGroup::done(std::uint64_t ticket) const {
+        std::lock_guard lock(m);
+        return finished >= ticket;
+    }
+
+    void ProcessGroup::all_reduce(float* data, std::size_t n) {
+        wait(all_reduce_async(data, n));
+    }
+
+    // Sum with zeros everywhere but root, which adds nothing to its values.
+    void ProcessGroup::broadcast(float* data, std::size_t n, std::size_t root) {
+        if (root >= world_) {
+            throw std::logic_error("ProcessGroup::broadcast: no rank " + std::to_string(root));
+        }
+        if (rank_ != root) {
+            std::fill_n(data, n, 0.0f);
+        }
+        all_reduce(data, n);
+    }
+
+    void ProcessGroup::barrier() {
+        float token = 0.0f;
+        all_reduce(&token, 1);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wolf::runtime {
+
+// Processes of one host that train a model together (see Sequential::set_process_group).
+// They share a POSIX shared memory segment holding one double-buffered mailbox per rank;
+// all_reduce is a ring over the ranks, reduce-scatter then all-gather, in chunks of
+// mailbox size. Each rank moves 2 (world - 1) / world of the data whatever the world
+// size, and every rank ends with the same bits. No MPI, no sockets. POSIX only.
+//
+//     auto group = wolf::runtime::ProcessGroup::spawn(4); // Before any parallel work
+//     model.set_process_group(group);
+//     for (...) model.train_step(shard_x(group->rank()), shard_t(group->rank()));
+class ProcessGroup {
+public:
+    // Joins the group `name` (a shared memory name like "/wolf-job42") as rank of world,
+    // for processes started some other way. Rank 0 creates the segment, replacing any
+    // stale one of the same name, and unlinks it once every rank has joined, so the name
+    // can only be used by one group at a time. Blocks until all ranks are there.
+    ProcessGroup(const std::string& name, std::size_t rank, std::size_t world);
+    // Forks world - 1 copies of the calling process and returns the group of each, rank 0
+    // in the caller. Only the calling thread survives a fork, so this must run before the
+    // thread pool starts. On Linux each rank is restricted to its share of the CPUs the
+    // caller may run on, so their pools (sized to those CPUs) do not overlap; launch
+    // with numactl --cpunodebind to keep the shares within NUMA nodes.
+    // Rank 0's destructor waits for the other ranks to exit.
+    static std::shared_ptr<ProcessGroup> spawn(std::size_t world);
+    ~ProcessGroup();
+    ProcessGroup(const ProcessGroup&) = delete;
+    ProcessGroup& operator=(const ProcessGroup&) = delete;
+
+    std::size_t rank() const { return rank_; }
+    std::size_t world() const { return world_; }
+
+    // Sums data[0, n) over the ranks, in place. Every rank must make the same calls with
+    // the same n, in the same order. Throws if another rank has exited.
+    void all_reduce(float* data, std::size_t n);
+    // Copies data[0, n) of rank root to every rank.
+    void broadcast(float* data, std::size_t n, std::size_t root = 0);
+    void barrier();
+
+    // all_reduce on the group's communication thread, which runs requests one at a time
+    // in submission order. data must stay valid and untouched until wait() on the
+    // returned ticket. Ticket 0 is never issued: wait(0) returns at once.
+    std::uint64_t all_reduce_async(float* data, std::size_t n);
+    // Blocks until the request is done; rethrows its error, if any.
+    void wait(std::uint64_t ticket);
+    bool done(std::uint64_t ticket) const;
+
+private:
+    struct Segment;
+    struct RankState;
+
+    ProcessGroup(std::size_t rank, std::size_t world);
+    void start();
+    void run_queue();
+    void ring_all_reduce(float* data, std::size_t n);
+    void send(const float* src, std::size_t n);
+    template <bool Add> void receive(float* dst, std::size_t n);
+    void wait_for(const std::atomic<std::uint64_t>& counter, std::uint64_t target, std::size_t peer);
+    RankState& state(std::size_t r) const;
+    float* mailbox(std::size_t r, std::uint64_t message) const;
+
+    std::size_t rank_ = 0;
+    std::size_t world_ = 1;
+    Segment* seg = nullptr; // Mapped shared memory
+    std::size_t seg_bytes = 0;
+    std::vector<int> children; // Pids forked by spawn(), in rank 0
+    std::uint64_t sent = 0;     // Messages this rank posted to its mailbox
+    std::uint64_t received = 0; // Messages read from the left neighbour's
+
+    struct Request {
+        float* data;
+        std::size_t n;
+    };
+    mutable std::mutex m;
+    mutable std::condition_variable cv;
+    std::deque<Request> queue;
+    std::uint64_t submitted = 0;
+    std::uint64_t finished = 0;
+    std::exception_ptr error;
+    bool stop = false;
+    std::thread comm;
+};
+
+}
@@ -0,0 +1,141 @@
+#include <runtime/Profiler.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+namespace wolf::runtime {
+    namespace {
+        std::atomic<uint32_t> next_thread{0};
+        thread_local uint32_t this_thread = next_thread.fetch_add(1);
+        thread_local uint64_t waited_ns = 0;
+
+        uint64_t clock_ns() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        void write_escaped(std::FILE* f, const std::string& s) {
+            for (char c : s) {
+                if (c == '"' || c == '\\') {
+                    std::fputc('\\', f);
+                }
+                std::fputc(static_cast<unsigned char>(c) < 0x20 ? ' ' : c, f);
+            }
+        }
+    }
+
+    const char* phase_name(Phase p) {
+        switch (p) {
+            case Phase::Forward: return "forward";
+            case Phase::Backward: return "backward";
+            case Phase::Step: return "step";
+            case Phase::Loss: return "loss";
+        }
+        return "?";
+    }
+
+    uint32_t thread_index() {
+        return this_thread;
+    }
+
+    uint64_t thread_wait_ns() {
+        return waited_ns;
+    }
+
+    void add_thread_wait_ns(uint64_t ns) {
+        waited_ns += ns;
+    }
+
+    Profiler::Profiler() : origin(clock_ns()) {}
+
+    uint64_t Profiler::now_ns() const {
+        return clock_ns() - origin;
+    }
+
+    void Profiler::describe(std::vector<std::string> names) {
+        std::lock_guard lock(m);
+        bool same = names.size() <= totals.size();
+        for (std::size_t i = 0; same && i < names.size(); ++i) {
+            same = totals[i].name == names[i];
+        }
+        if (same) {
+            return;
+        }
+        totals.assign(names.size(), LayerProfile{});
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            totals[i].name = std::move(names[i]);
+        }
+    }
+
+    void Profiler::record(const ProfileEvent& e) {
+        std::lock_guard lock(m);
+        while (totals.size() <= e.layer) {
+            totals.push_back(LayerProfile{"layer " + std::to_string(totals.size()), {}});
+        }
+        PhaseTotals& t = totals[e.layer].phases[static_cast<std::size_t>(e.phase)];
+        ++t.calls;
+        t.ns += e.dur_ns;
+        t.wait_ns += e.wait_ns;
+        t.flops += e.flops;
+        t.bytes += e.bytes;
+        if (log.size() < max_events) {
+            log.push_back(e);
+        } else {
+            ++overflow;
+        }
+    }
+
+    void Profiler::clear() {
+        std::lock_guard lock(m);
+        for (auto& l : totals) {
+            l.phases = {};
+        }
+        log.clear();
+        overflow = 0;
+        origin = clock_ns();
+    }
+
+    std::vector<LayerProfile> Profiler::layers() const {
+        std::lock_guard lock(m);
+        return totals;
+    }
+
+    std::vector<ProfileEvent> Profiler::events() const {
+        std::lock_guard lock(m);
+        return log;
+    }
+
+    std::size_t Profiler::dropped() const {
+        std::lock_guard lock(m);
+        return overflow;
+    }
+
+    // One complete ("X") event per record, timestamps in microseconds.
+    void Profiler::write_chrome_trace(const std::string& path) const {
+        std::lock_guard lock(m);
+        std::FILE* f = std::fopen(path.c_str(), "w");
+        if (f == nullptr) {
+            throw std::runtime_error("Profiler::write_chrome_trace: failed to open " + path);
+        }
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", f);
+        for (std::size_t i = 0; i < log.size(); ++i) {
+            const ProfileEvent& e = log[i];
+            std::fputs(i == 0 ? "\n{\"name\":\"" : ",\n{\"name\":\"", f);
+            if (e.layer < totals.size()) {
+                write_escaped(f, totals[e.layer].name);
+            } else {
+                std::fprintf(f, "layer %u", e.layer);
+            }
+            std::fprintf(f, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                            "\"args\":{\"layer\":%u,\"flops\":%.0f,\"bytes\":%.0f,\"pool_wait_us\":%.3f}}",
+                         phase_name(e.phase), e.thread, e.start_ns * 1e-3, e.dur_ns * 1e-3,
+                         e.layer, e.flops, e.bytes, e.wait_ns * 1e-3);
+        }
+        std::fputs("\n]}\n", f);
+        const bool failed = std::ferror(f) != 0;
+        if (std::fclose(f) != 0 || failed) {
+            throw std::runtime_error("Profiler::write_chrome_trace: failed to write " + path);
+        }
+    }
+}
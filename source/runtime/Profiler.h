@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wolf::runtime {
+
+// The instrumentation is compiled in only with WOLF_PROFILE defined (CMake option of the
+// same name). Otherwise every probe is empty and profiles stay empty.
+#if defined(WOLF_PROFILE)
+inline constexpr bool profiling = true;
+#else
+inline constexpr bool profiling = false;
+#endif
+
+enum class Phase : uint8_t {
+    Forward,
+    Backward,
+    Step, // Optimizer update
+    Loss,
+};
+inline constexpr std::size_t num_phases = 4;
+const char* phase_name(Phase p);
+
+struct ProfileEvent {
+    Phase phase;
+    uint32_t layer;    // Slot, see Profiler::describe()
+    uint32_t thread;   // thread_index() of the thread that ran it
+    uint64_t start_ns; // Since the profiler was created or cleared
+    uint64_t dur_ns;
+    uint64_t wait_ns;  // Part of dur_ns this thread spent in TaskGroup::wait with nothing to run
+    double flops;
+    double bytes;      // Moved to and from memory, assuming nothing was cached
+};
+
+struct PhaseTotals {
+    uint64_t calls = 0;
+    uint64_t ns = 0;
+    uint64_t wait_ns = 0;
+    double flops = 0;
+    double bytes = 0;
+};
+
+struct LayerProfile {
+    std::string name;
+    std::array<PhaseTotals, num_phases> phases{};
+
+    const PhaseTotals& operator[](Phase p) const { return phases[static_cast<std::size_t>(p)]; }
+};
+
+// Collects timed events from any number of threads. Totals are kept per slot and phase;
+// the events themselves are kept for write_chrome_trace() up to max_events.
+class Profiler {
+public:
+    static constexpr std::size_t max_events = std::size_t{1} << 20;
+
+    Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Names the slots; totals recorded under other names are dropped.
+    void describe(std::vector<std::string> names);
+    void record(const ProfileEvent& e);
+    void clear();
+    // Nanoseconds on the clock of ProfileEvent::start_ns.
+    uint64_t now_ns() const;
+
+    std::vector<LayerProfile> layers() const;
+    std::vector<ProfileEvent> events() const;
+    // Events past max_events, counted in the totals but missing from the trace.
+    std::size_t dropped() const;
+    // Chrome trace_event JSON, for chrome://tracing or ui.perfetto.dev.
+    void write_chrome_trace(const std::string& path) const;
+
+private:
+    mutable std::mutex m;
+    uint64_t origin;
+    std::vector<LayerProfile> totals;
+    std::vector<ProfileEvent> log;
+    std::size_t overflow = 0;
+};
+
+// Small id of the calling thread, stable for its lifetime.
+uint32_t thread_index();
+// Time the calling thread has spent in TaskGroup::wait with no task to run (WOLF_PROFILE only).
+uint64_t thread_wait_ns();
+void add_thread_wait_ns(uint64_t ns);
+
+}
@@ -0,0 +1,321 @@
+#include <runtime/ThreadPool.h>
+#include <runtime/Profiler.h>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace wolf::runtime {
+    namespace {
+        // Which pool and queue the current thread works for (external threads: none).
+        thread_local ThreadPool* current_pool = nullptr;
+        thread_local std::size_t current_queue = 0;
+
+        // Polls before a worker goes to sleep.
+        constexpr int spin_rounds = 4096;
+
+        inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+            _mm_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+
+        std::size_t default_threads() {
+            if (const char* env = std::getenv("WOLF_NUM_THREADS")) {
+                const long n = std::strtol(env, nullptr, 10);
+                if (n > 0) {
+                    return static_cast<std::size_t>(n);
+                }
+            }
+#if defined(__linux__)
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0 && CPU_COUNT(&allowed) > 0) {
+                return static_cast<std::size_t>(CPU_COUNT(&allowed));
+            }
+#endif
+            const unsigned hw = std::thread::hardware_concurrency();
+            return hw == 0 ? 1 : hw;
+        }
+
+        void pin_to_cpu(std::size_t index) {
+#if defined(__linux__)
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+                return;
+            }
+            const int n = CPU_COUNT(&allowed);
+            if (n == 0) {
+                return;
+            }
+            // index-th allowed CPU, wrapping around
+            int want = static_cast<int>(index % static_cast<std::size_t>(n));
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed) && want-- == 0) {
+                    cpu_set_t one;
+                    CPU_ZERO(&one);
+                    CPU_SET(cpu, &one);
+                    pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+                    return;
+                }
+            }
+#else
+            (void)index;
+#endif
+        }
+
+        // Owned by global_pool, read lock-free on every parallel call.
+        std::atomic<ThreadPool*> active{nullptr};
+        std::unique_ptr<ThreadPool> global_pool;
+        std::mutex global_mutex;
+    }
+
+    bool ThreadPool::Deque::push_back(const Task& t) {
+        std::lock_guard lock(m);
+        if (count == capacity) {
+            return false;
+        }
+        ring[(head + count) % capacity] = t;
+        ++count;
+        size.store(count, std::memory_order_release);
+        return true;
+    }
+
+    bool ThreadPool::Deque::pop_back(Task& t) {
+        if (size.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::lock_guard lock(m);
+        if (count == 0) {
+            return false;
+        }
+        --count;
+        t = ring[(head + count) % capacity];
+        size.store(count, std::memory_order_release);
+        return true;
+    }
+
+    bool ThreadPool::Deque::pop_front(Task& t) {
+        if (size.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::lock_guard lock(m);
+        if (count == 0) {
+            return false;
+        }
+        t = ring[head];
+        head = (head + 1) % capacity;
+        --count;
+        size.store(count, std::memory_order_release);
+        return true;
+    }
+
+    ThreadPool::ThreadPool(std::size_t threads, Affinity affinity) : pin(affinity) {
+        const std::size_t n_workers = threads > 1 ? threads - 1 : 0;
+        num_queues = n_workers + 1;
+        queues = std::make_unique<Deque[]>(num_queues);
+        workers.reserve(n_workers);
+        for (std::size_t i = 0; i < n_workers; ++i) {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        stop.store(true);
+        epoch.fetch_add(1);
+        epoch.notify_all();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    // Workers use their own deque; every other thread shares the last one.
+    std::size_t ThreadPool::local_queue() const {
+        return current_pool == this ? current_queue : num_queues - 1;
+    }
+
+    void ThreadPool::push(const Task& t) {
+        if (!queues[local_queue()].push_back(t)) {
+            // Full: run it here rather than block
+            execute(t);
+            return;
+        }
+        epoch.fetch_add(1);
+        if (sleepers.load() > 0) {
+            epoch.notify_all();
+        }
+    }
+
+    bool ThreadPool::has_work() const {
+        for (std::size_t q = 0; q < num_queues; ++q) {
+            if (queues[q].size.load(std::memory_order_acquire) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Newest task of our own deque first (still warm in cache), otherwise steal the oldest of another.
+    bool ThreadPool::try_run_one() {
+        const std::size_t self = local_queue();
+        Task t;
+        if (queues[self].pop_back(t)) {
+            execute(t);
+            return true;
+        }
+        for (std::size_t i = 1; i < num_queues; ++i) {
+            if (queues[(self + i) % num_queues].pop_front(t)) {
+                execute(t);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::execute(Task t) {
+        TaskGroup& group = *t.group;
+        if (!group.failed.load(std::memory_order_relaxed)) {
+            try {
+                // Split off the upper half until one chunk is left
+                while (t.end - t.begin > t.grain) {
+                    const std::size_t chunks = (t.end - t.begin + t.grain - 1) / t.grain;
+                    const std::size_t mid = t.begin + chunks / 2 * t.grain;
+                    Task upper = t;
+                    upper.begin = mid;
+                    group.pending.fetch_add(1);
+                    if (!queues[local_queue()].push_back(upper)) {
+                        group.pending.fetch_sub(1);
+                        break;
+                    }
+                    epoch.fetch_add(1);
+                    if (sleepers.load() > 0) {
+                        epoch.notify_all();
+                    }
+                    t.end = mid;
+                }
+                for (std::size_t b = t.begin; b < t.end; b += t.grain) {
+                    t.fn(t.ctx, b, b + t.grain < t.end ? b + t.grain : t.end);
+                }
+            } catch (...) {
+                if (!group.failed.exchange(true)) {
+                    group.error = std::current_exception();
+                }
+            }
+        }
+        // Last touch of the group: the waiter may destroy it right after
+        group.pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void ThreadPool::worker_loop(std::size_t index) {
+        current_pool = this;
+        current_queue = index;
+        if (pin == Affinity::Compact) {
+            pin_to_cpu(index);
+        }
+        while (!stop.load(std::memory_order_relaxed)) {
+            bool ran = false;
+            for (int i = 0; i < spin_rounds && !stop.load(std::memory_order_relaxed); ++i) {
+                if (try_run_one()) {
+                    ran = true;
+                    break;
+                }
+                cpu_relax();
+            }
+            if (ran) {
+                continue;
+            }
+            // Read the epoch before the last check so a push in between wakes us.
+            const uint32_t e = epoch.load();
+            sleepers.fetch_add(1);
+            if (!has_work() && !stop.load()) {
+                epoch.wait(e);
+            }
+            sleepers.fetch_sub(1);
+        }
+    }
+
+    TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool) {}
+    TaskGroup::TaskGroup() : pool(runtime::pool()) {}
+
+    TaskGroup::~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+        }
+    }
+
+    void TaskGroup::submit(void (*fn)(void*, std::size_t, std::size_t), void* ctx,
+                           std::size_t begin, std::size_t end, std::size_t grain) {
+        pending.fetch_add(1);
+        pool.push(ThreadPool::Task{fn, ctx, begin, end, grain, this});
+    }
+
+    void TaskGroup::wait() {
+        // Profiled builds time the stretches spent spinning with nothing to run.
+        std::chrono::steady_clock::time_point idle_since{};
+        auto end_idle = [&] {
+            if constexpr (profiling) {
+                if (idle_since != std::chrono::steady_clock::time_point{}) {
+                    add_thread_wait_ns(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - idle_since).count()));
+                    idle_since = {};
+                }
+            }
+        };
+        while (pending.load(std::memory_order_acquire) != 0) {
+            if (pool.try_run_one()) {
+                end_idle();
+            } else {
+                if constexpr (profiling) {
+                    if (idle_since == std::chrono::steady_clock::time_point{}) {
+                        idle_since = std::chrono::steady_clock::now();
+                    }
+                }
+                cpu_relax();
+            }
+        }
+        end_idle();
+        if (failed.load()) {
+            failed.store(false);
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    }
+
+    ThreadPool& pool() {
+        if (ThreadPool* p = active.load(std::memory_order_acquire)) {
+            return *p;
+        }
+        std::lock_guard lock(global_mutex);
+        if (!global_pool) {
+            global_pool = std::make_unique<ThreadPool>(default_threads());
+            active.store(global_pool.get(), std::memory_order_release);
+        }
+        return *global_pool;
+    }
+
+    bool pool_started() {
+        return active.load(std::memory_order_acquire) != nullptr;
+    }
+
+    void configure(std::size_t threads, Affinity affinity) {
+        std::lock_guard lock(global_mutex);
+        active.store(nullptr, std::memory_order_release);
+        global_pool.reset();
+        global_pool = std::make_unique<ThreadPool>(threads == 0 ? default_threads() : threads, affinity);
+        active.store(global_pool.get(), std::memory_order_release);
+    }
+
+    std::size_t num_threads() {
+        return pool().size();
+    }
+}
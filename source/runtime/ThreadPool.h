@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace wolf::runtime {
+
+enum class Affinity : uint8_t {
+    None,    // Let the OS place the workers
+    Compact, // Pin worker i to the i-th CPU this process may run on (Linux only)
+};
+
+class ThreadPool;
+
+// A set of range tasks that can be waited on together. Ranges are split lazily:
+// whoever runs a range larger than its grain pushes the upper half back for
+// idle threads to steal, so chunk boundaries are always multiples of grain.
+// Nothing is allocated per task.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool);
+    TaskGroup();  // On the global pool
+    ~TaskGroup(); // Waits
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Queues fn(b, e) over [begin, end) in chunks of grain elements and returns at once.
+    // fn is referenced, not copied: it must stay alive until wait() returns.
+    template <class F>
+    void run(std::size_t begin, std::size_t end, std::size_t grain, F& fn) {
+        if (begin >= end) {
+            return;
+        }
+        using Fn = std::remove_reference_t<F>;
+        submit(&invoke<Fn>, const_cast<void*>(static_cast<const void*>(&fn)), begin, end, grain == 0 ? 1 : grain);
+    }
+    // Runs queued tasks on this thread until every task of the group is done.
+    // Rethrows the first exception a task threw.
+    void wait();
+
+private:
+    friend class ThreadPool;
+    template <class Fn>
+    static void invoke(void* ctx, std::size_t begin, std::size_t end) {
+        (*static_cast<Fn*>(ctx))(begin, end);
+    }
+    void submit(void (*fn)(void*, std::size_t, std::size_t), void* ctx,
+                std::size_t begin, std::size_t end, std::size_t grain);
+
+    ThreadPool& pool;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+};
+
+// Persistent workers shared by every parallel kernel of the library.
+// Each worker owns a deque: it pushes and pops at the back, idle threads steal
+// the oldest (largest) ranges from the front. Workers spin briefly between
+// tasks so the many short loops of one training step don't pay a wake-up each.
+class ThreadPool {
+public:
+    // threads counts the calling thread, which helps while it waits.
+    explicit ThreadPool(std::size_t threads, Affinity affinity = Affinity::None);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size() + 1; }
+    Affinity affinity() const { return pin; }
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        void (*fn)(void*, std::size_t, std::size_t);
+        void* ctx;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t grain;
+        TaskGroup* group;
+    };
+
+    // Fixed-capacity ring; when full the owner runs the range itself.
+    struct Deque {
+        static constexpr std::size_t capacity = 256;
+        std::mutex m;
+        std::array<Task, capacity> ring;
+        std::size_t head = 0; // Oldest
+        std::size_t count = 0;
+        std::atomic<std::size_t> size{0};
+        bool push_back(const Task& t);
+        bool pop_back(Task& t);
+        bool pop_front(Task& t);
+    };
+
+    void push(const Task& t);
+    bool try_run_one();
+    void execute(Task t);
+    void worker_loop(std::size_t index);
+    bool has_work() const;
+    std::size_t local_queue() const;
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<Deque[]> queues; // One per worker, the last for outside threads
+    std::size_t num_queues = 0;
+    Affinity pin;
+    std::atomic<bool> stop{false};
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<int> sleepers{0};
+};
+
+// The pool used by parallel_for, GEMM and the optimizers. Created on first use with
+// WOLF_NUM_THREADS threads if set, otherwise one per CPU this process may run on.
+ThreadPool& pool();
+// Whether pool() has been created (fork() would leave a copy without its workers).
+bool pool_started();
+// Replaces the global pool. threads = 0 picks the default above.
+// Must not be called while the library is running parallel work.
+void configure(std::size_t threads, Affinity affinity = Affinity::None);
+std::size_t num_threads();
+
+// Runs fn(begin, end) over [0, n) in chunks of grain elements and returns when all are done.
+// A single chunk, or a pool of one thread, runs inline.
+template <class F>
+void parallel_for(std::size_t n, std::size_t grain, F&& fn) {
+    if (grain == 0) {
+        grain = 1;
+    }
+    if (n <= grain || num_threads() == 1) {
+        for (std::size_t begin = 0; begin < n; begin += grain) {
+            fn(begin, begin + grain < n ? begin + grain : n);
+        }
+        return;
+    }
+    TaskGroup group;
+    group.run(0, n, grain, fn);
+    group.wait();
+}
+
+}
@@ -3,7 +3,15 @@
 #include <span>
 #include <random>
 #include <math/tensor.h>
+#include <math/aligned.h>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <condition_variable>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
 #include <external/zpp_bits.h>
 namespace wolf{
 
@@ -12,15 +20,22 @@ namespace wolf{
         return TensorView{x.data() + offset, batch_size, x_dim};
     }
 
+    // Rows [sample_number, sample_number + batch_size) of x, whatever its strides; no copy.
+    inline TensorView make_batch_view(const TensorView& x, size_t sample_number, size_t batch_size) {
+        return x.slice_rows(sample_number, sample_number + batch_size);
+    }
+
+    // Gathers rows indices[start_sample, start_sample + batch_size) of data (one sample per
+    // row, any strides) into batch_buf and views them there.
     inline TensorView make_batch_view_indexed(
-    std::span<float> data,                // flattened data
-    std::size_t dim,                      // features per sample
+    const TensorView& data,
     std::span<const std::size_t> indices, // permutation
     std::size_t start_sample,             // index in indices
     std::size_t batch_size,
     Tensor& batch_buf                     // output data location
     ) {
-        const std::size_t num_samples = data.size() / dim;
+        const std::size_t num_samples = data.rows;
+        const std::size_t dim = data.cols;
         if (num_samples == 0 || batch_size == 0) {
             return TensorView{nullptr, 0, dim};
         }
@@ -33,22 +48,34 @@ namespace wolf{
 
         // Ensure buffer has enough storage
         if (batch_buf.empty() || batch_buf.data().size() < needed) {
-            batch_buf = Tensor(std::move(std::vector<float>(needed)), batch_size, dim);
+            batch_buf = Tensor(batch_size, dim);
         }
-
-        auto& buf = batch_buf.data();
+        batch_buf.set_rows(batch_size);
+        batch_buf.set_cols(dim);
+        TensorView out{batch_buf};
 
         for (std::size_t i = 0; i < batch_size; ++i) {
             std::size_t sample_idx = indices[start_sample + i];
-            const float* src = data.data() + sample_idx * dim;
-            float* dst = buf.data() + i * dim;
-            std::copy_n(src, dim, dst);
+            if (data.row_major()) {
+                std::copy_n(data.row(sample_idx), dim, out.row(i));
+            } else {
+                copy_view(data.slice_rows(sample_idx, sample_idx + 1), out.slice_rows(i, i + 1));
+            }
         }
 
-        batch_buf.set_rows(batch_size);
-        batch_buf.set_cols(dim);
+        return out;
+    }
 
-        return TensorView{batch_buf};
+    inline TensorView make_batch_view_indexed(
+    std::span<float> data,                // flattened data
+    std::size_t dim,                      // features per sample
+    std::span<const std::size_t> indices, // permutation
+    std::size_t start_sample,             // index in indices
+    std::size_t batch_size,
+    Tensor& batch_buf                     // output data location
+    ) {
+        return make_batch_view_indexed(TensorView{data.data(), data.size() / dim, dim},
+                                       indices, start_sample, batch_size, batch_buf);
     }
 
     struct BatchMaker {
@@ -60,15 +87,51 @@ namespace wolf{
             : indices(num_samples) {
             std::iota(indices.begin(), indices.end(), 0);
         }
+        BatchMaker(BatchMaker&&) = default;
+        // Our prefetch worker gathers through our indices: stop it before they are replaced.
+        BatchMaker& operator=(BatchMaker&& other) noexcept {
+            if (this != &other) {
+                disable_prefetch();
+                x_buf = std::move(other.x_buf);
+                t_buf = std::move(other.t_buf);
+                indices = std::move(other.indices);
+                prefetch = std::move(other.prefetch);
+            }
+            return *this;
+        }
+        ~BatchMaker() { disable_prefetch(); }
 
         void shuffle(std::uniform_random_bit_generator auto& gen) {
+            if (!prefetch) {
+                std::shuffle(indices.begin(), indices.end(), gen);
+                return;
+            }
+            std::unique_lock lock(prefetch->m);
+            prefetch->restart(lock, 0); // Never gather while the order changes
             std::shuffle(indices.begin(), indices.end(), gen);
+            prefetch->cv.notify_all();
+        }
+
+        // A background thread gathers the next `depth` batches of the epoch into a ring of
+        // reused aligned buffers while the current one trains. x_batch and t_batch keep their
+        // interface and return views of the same ring slot, valid until the next batch is
+        // requested. Batches are expected in order with this batch_size; any other start
+        // restarts the prefetch from there.
+        void enable_prefetch(std::span<float> x_data, size_t x_dim,
+                             std::span<float> t_data, size_t t_dim,
+                             size_t batch_size, size_t depth = 2) {
+            disable_prefetch();
+            prefetch = std::make_unique<Prefetch>(*this, x_data, x_dim, t_data, t_dim, batch_size, depth);
         }
+        void disable_prefetch() { prefetch.reset(); }
 
         TensorView x_batch(std::span<float> x_data,
                         size_t x_dim,
                         size_t start_sample,
                         size_t batch_size) {
+            if (prefetch) {
+                return prefetch->x_view(prefetch->take(x_data, start_sample, batch_size));
+            }
             return make_batch_view_indexed(
                 x_data, x_dim,
                 std::span<const size_t>(indices),
@@ -81,6 +144,9 @@ namespace wolf{
                         size_t t_dim,
                         size_t start_sample,
                         size_t batch_size) {
+            if (prefetch) {
+                return prefetch->t_view(prefetch->take(t_data, start_sample, batch_size));
+            }
             return make_batch_view_indexed(
                 t_data, t_dim,
                 std::span<const size_t>(indices),
@@ -89,12 +155,117 @@ namespace wolf{
             );
         }
 
-        // Tensor make_batch(std::span<float> t_data,
-        //                 size_t start_sample,
-        //                 size_t batch_size) {
-        //     indices[start_sample];
-        //     return Tensor(std::vector<float>{}, 1, batch_size);
-        // }
+    private:
+        struct Prefetch {
+            struct Slot {
+                AlignedBuffer x;
+                AlignedBuffer t;
+                size_t start = 0;
+                size_t rows = 0;
+            };
+
+            std::span<const size_t> indices; // The owner's; its storage survives moves of the owner
+            std::span<float> x_data;
+            std::span<float> t_data;
+            size_t x_dim;
+            size_t t_dim;
+            size_t batch;
+            size_t depth;
+            std::vector<Slot> ring; // depth in flight plus the one being trained on
+            std::mutex m;
+            std::condition_variable cv;
+            size_t filled = 0;      // Batches gathered so far; batch i lives in ring[i % ring.size()]
+            size_t taken = 0;       // Batches handed out; taken - 1 is the one in use
+            size_t next_start = 0;  // Sample the next gathered batch starts at
+            bool busy = false;      // Worker is gathering outside the lock
+            bool stop = false;
+            std::thread worker;
+
+            Prefetch(const BatchMaker& owner, std::span<float> x_data, size_t x_dim,
+                     std::span<float> t_data, size_t t_dim, size_t batch_size, size_t depth)
+                : indices(owner.indices), x_data(x_data), t_data(t_data), x_dim(x_dim), t_dim(t_dim),
+                  batch(batch_size), depth(std::max<size_t>(depth, 1)), ring(this->depth + 1) {
+                for (auto& slot : ring) {
+                    slot.x = AlignedBuffer(batch * x_dim);
+                    slot.t = AlignedBuffer(batch * t_dim);
+                }
+                worker = std::thread([this] { run(); });
+            }
+            ~Prefetch() {
+                {
+                    std::lock_guard lock(m);
+                    stop = true;
+                }
+                cv.notify_all();
+                worker.join();
+            }
+
+            void run() {
+                std::unique_lock lock(m);
+                for (;;) {
+                    cv.wait(lock, [&] { return stop || (filled - taken < depth && next_start < indices.size()); });
+                    if (stop) {
+                        return;
+                    }
+                    Slot& slot = ring[filled % ring.size()];
+                    slot.start = next_start;
+                    slot.rows = std::min(batch, indices.size() - next_start);
+                    busy = true;
+                    lock.unlock();
+                    for (size_t i = 0; i < slot.rows; ++i) {
+                        const size_t sample = indices[slot.start + i];
+                        std::copy_n(x_data.data() + sample * x_dim, x_dim, slot.x.data() + i * x_dim);
+                        std::copy_n(t_data.data() + sample * t_dim, t_dim, slot.t.data() + i * t_dim);
+                    }
+                    lock.lock();
+                    busy = false;
+                    next_start += slot.rows;
+                    ++filled;
+                    cv.notify_all();
+                }
+            }
+
+            // Drops the batches in flight and continues from start; waits out a running gather.
+            void restart(std::unique_lock<std::mutex>& lock, size_t start) {
+                cv.wait(lock, [&] { return !busy; });
+                filled = taken;
+                next_start = start;
+                if (taken > 0) {
+                    ring[(taken - 1) % ring.size()].start = SIZE_MAX; // Never matched again
+                }
+            }
+
+            // The slot holding the batch at start, advancing to it unless it is already in use.
+            Slot& take(std::span<float> data, size_t start, size_t rows) {
+                if (data.data() != x_data.data() && data.data() != t_data.data()) {
+                    throw std::logic_error("BatchMaker: prefetch enabled for other data");
+                }
+                if (start >= indices.size() || rows != std::min(batch, indices.size() - start)) {
+                    throw std::logic_error("BatchMaker: batch outside the epoch or not of the prefetch batch size");
+                }
+                std::unique_lock lock(m);
+                if (taken > 0 && ring[(taken - 1) % ring.size()].start == start) {
+                    return ring[(taken - 1) % ring.size()];
+                }
+                for (;;) {
+                    cv.wait(lock, [&] { return filled > taken || (!busy && next_start != start && filled == taken); });
+                    if (filled > taken && ring[taken % ring.size()].start == start) {
+                        break;
+                    }
+                    restart(lock, start);
+                    cv.notify_all();
+                }
+                Slot& slot = ring[taken % ring.size()];
+                ++taken;
+                cv.notify_all();
+                return slot;
+            }
+
+            TensorView x_view(Slot& s) { return TensorView{s.x.data(), s.rows, x_dim}; }
+            TensorView t_view(Slot& s) { return TensorView{s.t.data(), s.rows, t_dim}; }
+        };
+
+        std::unique_ptr<Prefetch> prefetch;
     };
 
     void save_tensor(const wolf::Tensor& t, const std::string& path) {
@@ -102,7 +273,10 @@ namespace wolf{
 
         const std::size_t rows = t.nrows();
         const std::size_t cols = t.ncols();
-        const std::vector<float> raw      = t.data();
+        std::vector<float> raw(t.size());
+        for (std::size_t r = 0; r < rows; ++r) {
+            std::copy_n(t.data().data() + r * t.ld(), cols, raw.data() + r * cols);
+        }
 
         // Serialize (rows, cols, data) in that order
         out(rows, cols, raw).or_throw();
@@ -149,7 +323,6 @@ namespace wolf{
     void export_tensor_csv(const wolf::Tensor& t, const std::string& path) {
         const std::size_t rows = t.nrows();
         const std::size_t cols = t.ncols();
-        const std::vector<float>& raw = t.data();
 
         std::ofstream file(path);
         if (!file) {
@@ -157,9 +330,8 @@ namespace wolf{
         }
 
         for (std::size_t r = 0; r < rows; ++r) {
-            const std::size_t base = r * cols;
             for (std::size_t c = 0; c < cols; ++c) {
-                file << raw[base + c];
+                file << t(r, c);
                 if (c + 1 < cols) {
                     file << ',';
                 }
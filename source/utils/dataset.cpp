@@ -0,0 +1,275 @@
+#include <utils/dataset.h>
+#include <math/simd/simd.h>
+#include <runtime/MappedFile.h>
+#include <runtime/ThreadPool.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace wolf {
+    namespace {
+        // Bytes of CSV per parse task; boundaries are moved forward to the next line start.
+        constexpr std::size_t chunk_bytes = 1 << 20;
+
+        // By its bits: this file builds with -ffast-math, under which std::isnan may fold to false.
+        bool is_nan(float v) {
+            uint32_t u;
+            std::memcpy(&u, &v, sizeof(u));
+            return (u & 0x7fffffffu) > 0x7f800000u;
+        }
+
+        struct DatasetFileHeader {
+            static constexpr std::array<char, 8> expected_magic{'W', 'O', 'L', 'F', 'D', 'S', 'E', 'T'};
+            static constexpr uint32_t current_version = 1;
+
+            std::array<char, 8> magic = expected_magic;
+            uint32_t version = current_version;
+            uint32_t reserved = 0;
+            uint64_t rows = 0;
+            uint64_t x_dim = 0;
+            uint64_t t_dim = 0;
+            uint64_t source = 0; // options_key() of the CSV it was parsed from, 0 if unknown
+        };
+
+        // FNV-1a over the options, so a cache built with other options is not reused.
+        uint64_t options_key(const CsvOptions& o) {
+            uint64_t h = 14695981039346656037ull;
+            auto mix = [&](const auto& v) {
+                unsigned char bytes[sizeof(v)];
+                std::memcpy(bytes, &v, sizeof(v));
+                for (unsigned char b : bytes) {
+                    h = (h ^ b) * 1099511628211ull;
+                }
+            };
+            mix(o.delimiter);
+            mix(o.header);
+            mix(static_cast<uint64_t>(o.label_column));
+            mix(static_cast<uint64_t>(o.num_classes));
+            mix(o.feature_scale);
+            return h == 0 ? 1 : h;
+        }
+
+        // One past the end of the line starting at p (after its '\n').
+        const char* next_line(const char* p, const char* end) {
+            const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+            return nl != nullptr ? static_cast<const char*>(nl) + 1 : end;
+        }
+
+        // End of the fields of the line [p, next): without "\n" or "\r\n".
+        const char* content_end(const char* p, const char* next) {
+            if (next > p && next[-1] == '\n') {
+                --next;
+            }
+            if (next > p && next[-1] == '\r') {
+                --next;
+            }
+            return next;
+        }
+
+        void write_dataset(const Dataset& data, const std::string& path, uint64_t source) {
+            DatasetFileHeader header;
+            header.rows = data.rows;
+            header.x_dim = data.x_dim;
+            header.t_dim = data.t_dim;
+            header.source = source;
+            std::ofstream file(path, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("save_dataset: failed to open " + path);
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(data.x.data()), static_cast<std::streamsize>(data.x.size() * sizeof(float)));
+            file.write(reinterpret_cast<const char*>(data.t.data()), static_cast<std::streamsize>(data.t.size() * sizeof(float)));
+            if (!file) {
+                throw std::runtime_error("save_dataset: failed to write " + path);
+            }
+        }
+
+        bool read_header(std::ifstream& file, DatasetFileHeader& header) {
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+                && header.magic == DatasetFileHeader::expected_magic
+                && header.version == DatasetFileHeader::current_version;
+        }
+    }
+
+    Dataset read_csv(const std::string& path, const CsvOptions& options) {
+        runtime::MappedFile file(path);
+        const char* begin = reinterpret_cast<const char*>(file.data());
+        const char* const end = begin + file.size();
+        if (options.header && begin != end) {
+            begin = next_line(begin, end);
+        }
+
+        // The first non-blank line fixes the number of columns
+        const char* first = begin;
+        while (first != end && content_end(first, next_line(first, end)) == first) {
+            first = next_line(first, end);
+        }
+        Dataset data;
+        if (first == end) {
+            return data;
+        }
+        const char* first_end = content_end(first, next_line(first, end));
+        const auto& k = simd::kernels();
+        const std::size_t cols = 1 + k.count_byte(first, static_cast<std::size_t>(first_end - first), options.delimiter);
+        if (options.label_column >= cols) {
+            throw std::runtime_error("read_csv: label column out of range in " + path);
+        }
+        data.x_dim = cols - 1;
+        data.t_dim = options.num_classes > 0 ? options.num_classes : 1;
+
+        // Chunks of whole lines
+        std::vector<const char*> bounds{begin};
+        while (bounds.back() != end) {
+            const char* b = bounds.back();
+            const char* e = static_cast<std::size_t>(end - b) > chunk_bytes ? next_line(b + chunk_bytes, end) : end;
+            bounds.push_back(e);
+        }
+        const std::size_t chunks = bounds.size() - 1;
+
+        // Upper bound on the rows of each chunk: its lines, blank ones included
+        std::vector<std::size_t> first_row(chunks + 1, 0);
+        runtime::parallel_for(chunks, 1, [&](std::size_t c, std::size_t) {
+            const std::size_t len = static_cast<std::size_t>(bounds[c + 1] - bounds[c]);
+            first_row[c + 1] = k.count_byte(bounds[c], len, '\n') + (bounds[c + 1][-1] != '\n');
+        });
+        for (std::size_t c = 0; c < chunks; ++c) {
+            first_row[c + 1] += first_row[c];
+        }
+        data.x.resize(first_row.back() * data.x_dim);
+        data.t.resize(first_row.back() * data.t_dim);
+
+        std::vector<std::size_t> parsed(chunks, 0);
+        runtime::parallel_for(chunks, 1, [&](std::size_t c, std::size_t) {
+            auto malformed = [&](const char* at) {
+                throw std::runtime_error("read_csv: malformed row at byte "
+                                         + std::to_string(at - reinterpret_cast<const char*>(file.data())) + " of " + path);
+            };
+            std::size_t row = first_row[c];
+            for (const char* line = bounds[c]; line != bounds[c + 1]; ) {
+                const char* next = next_line(line, bounds[c + 1]);
+                const char* e = content_end(line, next);
+                if (e == line) {
+                    line = next;
+                    continue;
+                }
+                float* x = data.x.data() + row * data.x_dim;
+                float* t = data.t.data() + row * data.t_dim;
+                const char* p = line;
+                for (std::size_t col = 0; col < cols; ++col) {
+                    while (p != e && *p == ' ') {
+                        ++p;
+                    }
+                    float v = 0.0f;
+                    const auto [after, ec] = std::from_chars(p, e, v);
+                    if (ec != std::errc{}) {
+                        malformed(line);
+                    }
+                    p = after;
+                    while (p != e && *p == ' ') {
+                        ++p;
+                    }
+                    if (col + 1 < cols) {
+                        if (p == e || *p != options.delimiter) {
+                            malformed(line);
+                        }
+                        ++p;
+                    }
+                    if (col == options.label_column) {
+                        if (options.num_classes == 0) {
+                            t[0] = v;
+                            continue;
+                        }
+                        // Checked before the cast, which is undefined for negative or huge v
+                        if (is_nan(v) || !(v >= 0.0f && v < static_cast<float>(options.num_classes) && v == std::floor(v))) {
+                            malformed(line);
+                        }
+                        t[static_cast<std::size_t>(v)] = 1.0f;
+                    } else {
+                        x[col < options.label_column ? col : col - 1] = v * options.feature_scale;
+                    }
+                }
+                if (p != e) {
+                    malformed(line);
+                }
+                ++row;
+                line = next;
+            }
+            parsed[c] = row - first_row[c];
+        });
+
+        // Close the gaps left by blank lines
+        std::size_t rows = parsed.empty() ? 0 : parsed[0];
+        for (std::size_t c = 1; c < chunks; ++c) {
+            if (rows != first_row[c]) {
+                std::memmove(data.x.data() + rows * data.x_dim, data.x.data() + first_row[c] * data.x_dim,
+                             parsed[c] * data.x_dim * sizeof(float));
+                std::memmove(data.t.data() + rows * data.t_dim, data.t.data() + first_row[c] * data.t_dim,
+                             parsed[c] * data.t_dim * sizeof(float));
+            }
+            rows += parsed[c];
+        }
+        data.rows = rows;
+        data.x.resize(rows * data.x_dim);
+        data.t.resize(rows * data.t_dim);
+        return data;
+    }
+
+    void save_dataset(const Dataset& data, const std::string& path) {
+        write_dataset(data, path, 0);
+    }
+
+    Dataset load_dataset(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            throw std::runtime_error("load_dataset: failed to open " + path);
+        }
+        const auto size = static_cast<uint64_t>(file.tellg());
+        file.seekg(0, std::ios::beg);
+        DatasetFileHeader header;
+        if (!read_header(file, header)) {
+            throw std::runtime_error("load_dataset: not a dataset file: " + path);
+        }
+        const uint64_t floats = header.rows * (header.x_dim + header.t_dim);
+        if (size != sizeof(header) + floats * sizeof(float)) {
+            throw std::runtime_error("load_dataset: size mismatch in " + path);
+        }
+        Dataset data;
+        data.rows = header.rows;
+        data.x_dim = header.x_dim;
+        data.t_dim = header.t_dim;
+        data.x.resize(data.rows * data.x_dim);
+        data.t.resize(data.rows * data.t_dim);
+        file.read(reinterpret_cast<char*>(data.x.data()), static_cast<std::streamsize>(data.x.size() * sizeof(float)));
+        file.read(reinterpret_cast<char*>(data.t.data()), static_cast<std::streamsize>(data.t.size() * sizeof(float)));
+        if (!file) {
+            throw std::runtime_error("load_dataset: failed to read " + path);
+        }
+        return data;
+    }
+
+    Dataset load_csv_cached(const std::string& csv_path, const std::string& cache_path, const CsvOptions& options) {
+        namespace fs = std::filesystem;
+        const uint64_t key = options_key(options);
+        std::error_code ec;
+        const auto cache_time = fs::last_write_time(cache_path, ec);
+        if (!ec && cache_time >= fs::last_write_time(csv_path)) {
+            std::ifstream file(cache_path, std::ios::binary);
+            DatasetFileHeader header;
+            if (read_header(file, header) && header.source == key) {
+                file.close();
+                return load_dataset(cache_path);
+            }
+        }
+        Dataset data = read_csv(csv_path, options);
+        // Written aside and renamed, so an interrupted run never leaves a truncated cache
+        const std::string tmp = cache_path + ".tmp";
+        write_dataset(data, tmp, key);
+        fs::rename(tmp, cache_path);
+        return data;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace wolf {
+
+// A whole dataset in memory: row-major features and targets, ready for BatchMaker.
+struct Dataset {
+    std::vector<float> x; // [rows x x_dim]
+    std::vector<float> t; // [rows x t_dim]
+    std::size_t rows = 0;
+    std::size_t x_dim = 0;
+    std::size_t t_dim = 0;
+
+    std::span<float> inputs() { return x; }
+    std::span<float> targets() { return t; }
+};
+
+struct CsvOptions {
+    char delimiter = ',';
+    bool header = true;           // Skip the first line
+    std::size_t label_column = 0; // Becomes the target, every other column a feature
+    std::size_t num_classes = 0;  // > 0: one-hot encode the label (t_dim = num_classes), else t_dim = 1
+    float feature_scale = 1.0f;   // Features are multiplied by this, e.g. 1 / 255 for pixels
+};
+
+// Parses a numeric CSV file on every pool thread. Blank lines are skipped;
+// a row with the wrong number of fields or a non-numeric field throws std::runtime_error.
+Dataset read_csv(const std::string& path, const CsvOptions& options = {});
+
+// Packed binary cache: a small header, then x and t as raw floats.
+void save_dataset(const Dataset& data, const std::string& path);
+Dataset load_dataset(const std::string& path);
+
+// load_dataset(cache_path) when the cache is newer than the CSV and was built with the
+// same options, otherwise read_csv() and rewrite the cache.
+Dataset load_csv_cached(const std::string& csv_path, const std::string& cache_path,
+                        const CsvOptions& options = {});
+
+}
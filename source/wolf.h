@@ -2,11 +2,16 @@
 #define WOLF_WOLF_H
 
 #include <math/tensor.h>
+#include <math/sparse.h>
 #include <model/Layer.h>
 #include <model/LinearLayer.h>
 #include <model/ReLU.h>
 #include <model/Sequential.h>
 #include <model/LayerFactory.h>
+#include <model/StaticSequential.h>
+#include <model/InferenceServer.h>
+#include <runtime/ProcessGroup.h>
 #include <utils/data.h>
+#include <utils/dataset.h>
 
 #endif
\ No newline at end of file
@@ -0,0 +1,194 @@
+// wolf_compile: turns a model saved by Sequential::save into a self-contained C++ header.
+//
+//   wolf_compile MODEL OUTPUT.h [--namespace NAME]
+//
+// The header holds the weights as constexpr alignas(64) arrays and an inline
+//     void NAME::predict(const float* x, float* y);
+// whose loops have the layer dimensions as constants. It needs C++17 and only includes
+// <cstddef>: no library, thread pool or zpp_bits, no file I/O or allocation at startup.
+// Linear and ReLU layers are supported.
+#include <model/ModelFile.h>
+#include <math/aligned.h>
+#include <external/zpp_bits.h>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <print>
+#include <string>
+#include <vector>
+
+using namespace wolf;
+
+namespace {
+    struct Options {
+        std::string model;
+        std::string output;
+        std::string ns = "wolf_model";
+    };
+
+    struct DenseLayer {
+        size_t in = 0, out = 0;
+        bool relu = false;     // Followed by a ReLU, applied in the same loop
+        std::vector<float> wt; // [in x out], transposed from LinearLayer's W
+        std::vector<float> b;
+    };
+
+    // Shortest text that reads back as the same float.
+    std::string float_literal(float v) {
+        if (!std::isfinite(v)) {
+            throw std::runtime_error("wolf_compile: model has a non-finite weight");
+        }
+        std::string s = std::format("{}", v);
+        if (s.find_first_of(".e") == std::string::npos) {
+            s += ".0";
+        }
+        return s + "f";
+    }
+
+    std::vector<DenseLayer> read_model(const std::string& path) {
+        const ModelFileReader file(path, "wolf_compile");
+        if (file.is_stream()) {
+            throw std::runtime_error("wolf_compile: " + path + " predates the mapped model format;"
+                                     " load it with Sequential::load and save it again");
+        }
+        std::vector<DenseLayer> layers;
+        for (size_t i = 0; i < file.num_layers(); ++i) {
+            const LayerRecord& rec = file.record(i);
+            if (rec.kind == LayerKind::ReLU) {
+                if (layers.empty() || layers.back().relu) {
+                    throw std::runtime_error(std::format("wolf_compile: layer {}: a ReLU must follow a Linear layer", i));
+                }
+                layers.back().relu = true;
+                continue;
+            }
+            if (rec.kind != LayerKind::Linear) {
+                throw std::runtime_error(std::format("wolf_compile: layer {}: only Linear and ReLU layers are supported", i));
+            }
+            std::vector<std::byte> shape = file.shape(i);
+            zpp::bits::in in(shape);
+            std::size_t x_dim{}, y_dim{};
+            in(x_dim, y_dim).or_throw();
+            if (rec.param_count != align_floats(y_dim * x_dim) + align_floats(y_dim)) {
+                throw std::runtime_error(std::format("wolf_compile: layer {}: parameter count mismatch", i));
+            }
+            if (!layers.empty() && layers.back().out != x_dim) {
+                throw std::runtime_error(std::format("wolf_compile: layer {} takes {} inputs, the previous layer gives {}",
+                                                     i, x_dim, layers.back().out));
+            }
+            const float* W = file.params() + rec.param_offset;
+            DenseLayer& l = layers.emplace_back();
+            l.in = x_dim;
+            l.out = y_dim;
+            l.wt.resize(x_dim * y_dim);
+            for (size_t o = 0; o < y_dim; ++o) {
+                for (size_t k = 0; k < x_dim; ++k) {
+                    l.wt[k * y_dim + o] = W[o * x_dim + k];
+                }
+            }
+            l.b.assign(W + align_floats(y_dim * x_dim), W + align_floats(y_dim * x_dim) + y_dim);
+        }
+        if (layers.empty()) {
+            throw std::runtime_error("wolf_compile: " + path + " has no Linear layer");
+        }
+        return layers;
+    }
+
+    void write_array(std::string& out, const std::string& name, const std::vector<float>& v) {
+        out += std::format("alignas(64) inline constexpr float {}[{}] = {{", name, v.size());
+        for (size_t i = 0; i < v.size(); ++i) {
+            out += i % 8 == 0 ? "\n    " : " ";
+            out += float_literal(v[i]);
+            out += ',';
+        }
+        out += "\n};\n";
+    }
+
+    std::string generate(const std::vector<DenseLayer>& layers, const Options& opt) {
+        std::string arch;
+        for (const DenseLayer& l : layers) {
+            arch += std::format("{}Linear({}, {}){}", arch.empty() ? "" : " -> ", l.in, l.out, l.relu ? " -> ReLU" : "");
+        }
+
+        std::string out;
+        out += std::format("// Generated by wolf_compile from {}; do not edit.\n// {}\n", opt.model, arch);
+        out += "#pragma once\n#include <cstddef>\n\n";
+        out += std::format("namespace {} {{\n\n", opt.ns);
+        out += std::format("inline constexpr std::size_t in_dim = {};\n", layers.front().in);
+        out += std::format("inline constexpr std::size_t out_dim = {};\n\n", layers.back().out);
+        out += "namespace detail {\n";
+        for (size_t i = 0; i < layers.size(); ++i) {
+            out += std::format("// Layer {}: weights [{} x {}], input-major\n", i, layers[i].in, layers[i].out);
+            write_array(out, std::format("w{}", i), layers[i].wt);
+            write_array(out, std::format("b{}", i), layers[i].b);
+        }
+        out += "}\n\n";
+
+        out += "// y[0, out_dim) = model(x[0, in_dim)). Reentrant; uses only the stack.\n";
+        out += "inline void predict(const float* x, float* y) {\n";
+        std::string cur = "x";
+        for (size_t i = 0; i < layers.size(); ++i) {
+            const DenseLayer& l = layers[i];
+            const std::string a = std::format("a{}", i);
+            out += std::format("    // Linear({}, {}){}\n", l.in, l.out, l.relu ? " + ReLU" : "");
+            out += std::format("    alignas(64) float {}[{}];\n", a, l.out);
+            out += std::format("    for (std::size_t o = 0; o < {}; ++o) {}[o] = detail::b{}[o];\n", l.out, a, i);
+            out += std::format("    for (std::size_t k = 0; k < {}; ++k) {{\n", l.in);
+            out += std::format("        const float v = {}[k];\n", cur);
+            out += std::format("        const float* w = detail::w{} + k * {};\n", i, l.out);
+            out += std::format("        for (std::size_t o = 0; o < {}; ++o) {}[o] += v * w[o];\n", l.out, a);
+            out += "    }\n";
+            if (l.relu) {
+                out += std::format("    for (std::size_t o = 0; o < {}; ++o) {}[o] = {}[o] > 0.0f ? {}[o] : 0.0f;\n",
+                                   l.out, a, a, a);
+            }
+            cur = a;
+        }
+        out += std::format("    for (std::size_t o = 0; o < {}; ++o) y[o] = {}[o];\n", layers.back().out, cur);
+        out += "}\n\n";
+        out += std::format("}} // namespace {}\n", opt.ns);
+        return out;
+    }
+
+    Options parse_args(int argc, char** argv) {
+        Options opt;
+        std::vector<std::string> positional;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--namespace") {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("wolf_compile: " + arg + " needs a value");
+                }
+                opt.ns = argv[++i];
+            } else if (arg.starts_with("--")) {
+                throw std::runtime_error("wolf_compile: unknown argument " + arg);
+            } else {
+                positional.push_back(arg);
+            }
+        }
+        if (positional.size() != 2) {
+            throw std::runtime_error("usage: wolf_compile MODEL OUTPUT.h [--namespace NAME]");
+        }
+        opt.model = positional[0];
+        opt.output = positional[1];
+        return opt;
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options opt = parse_args(argc, argv);
+        const std::vector<DenseLayer> layers = read_model(opt.model);
+        const std::string header = generate(layers, opt);
+        std::ofstream file(opt.output, std::ios::binary);
+        file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        if (!file) {
+            throw std::runtime_error("wolf_compile: failed to write " + opt.output);
+        }
+        std::println("{}: {} Linear layers, {} -> {}", opt.output, layers.size(), layers.front().in, layers.back().out);
+    } catch (const std::exception& e) {
+        std::println(stderr, "{}", e.what());
+        return 2;
+    }
+    return 0;
+}